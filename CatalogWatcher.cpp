@@ -0,0 +1,50 @@
+#include "CatalogWatcher.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+CatalogWatcher::CatalogWatcher(const QString& fileName, QObject *parent) :
+    QObject(parent),
+    catalogFile(QFileInfo(fileName).absoluteFilePath())
+{
+    settleTimer.setSingleShot(true);
+    settleTimer.setInterval(500);
+    connect(&settleTimer, SIGNAL(timeout()), SLOT(reload()));
+
+    // The directory is watched too, to see the file replaced by a rename
+    connect(&watcher, SIGNAL(fileChanged(QString)), SLOT(fileChanged()));
+    connect(&watcher, SIGNAL(directoryChanged(QString)), SLOT(fileChanged()));
+
+    watch();
+}
+
+void CatalogWatcher::reload() {
+    // A replaced file drops out of the watcher, take the new one
+    watch();
+
+    Catalog::ChangeSet changes;
+    if (!catalog.RefreshFile(QFile::encodeName(catalogFile).constData(), changes)) {
+        qWarning() << "Catalog not refreshed:" << catalog.Errors().front().message.c_str();
+        return;
+    }
+
+    foreach(const Catalog::Error& error, catalog.Errors()) {
+        qWarning() << catalogFile << "line" << error.line << error.message.c_str();
+    }
+
+    if (!changes.Empty())
+        emit catalogChanged(catalog, changes);
+}
+
+void CatalogWatcher::fileChanged() {
+    settleTimer.start();
+}
+
+void CatalogWatcher::watch() {
+    const QString directory = QFileInfo(catalogFile).absolutePath();
+    if (!watcher.directories().contains(directory))
+        watcher.addPath(directory);
+
+    if (!watcher.files().contains(catalogFile) && QFileInfo(catalogFile).exists())
+        watcher.addPath(catalogFile);
+}
@@ -0,0 +1,50 @@
+#ifndef CATALOGWATCHER_H
+#define CATALOGWATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QFileSystemWatcher>
+
+#include "Catalog.h"
+
+/*
+ * Keeps a catalog in step with a tle file. The file is watched and, once
+ * writing to it has settled, the catalog is refreshed from it. Only the
+ * satellites whose element set changed are initialised again, and the
+ * change set is published so that views recompute those alone.
+ */
+class CatalogWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CatalogWatcher(const QString& fileName, QObject *parent = 0);
+
+    const Catalog& currentCatalog() const { return catalog; }
+
+signals:
+
+    // Emitted after a refresh which changed something
+    void catalogChanged(const Catalog& catalog, const Catalog::ChangeSet& changes);
+
+public slots:
+
+    void reload();
+
+private slots:
+
+    void fileChanged();
+
+private:
+
+    void watch();
+
+    QString catalogFile;
+    Catalog catalog;
+
+    QFileSystemWatcher watcher;
+    // Editors and downloads write in several steps, wait for the last
+    QTimer settleTimer;
+};
+
+#endif // CATALOGWATCHER_H
@@ -1,9 +1,20 @@
 #include "PassCalculator.h"
 #include <QDebug>
 
+#include <vector>
+
+#include "TimeContext.h"
+#include "TimeGrid.h"
+#include "ChebyshevEphemeris.h"
+
 #define RAD2DEG (180.0/M_PI)
 PassCalculator::PassCalculator(QObject *parent) :
     QObject(parent),
+    satellite(Tle("ESTCUBE 1",
+                  "1 39161U 13021C   14226.14653900  .00000766  00000-0  13565-3 0  3794",
+                  "2 39161  98.0947 306.6139 0009384 203.0001 157.0783 14.70096049 68114")),
+    noradNumber(39161),
+    observer(CoordGeodetic()),
     miniumElevation(5.0)
 {
 
@@ -15,28 +26,31 @@ void PassCalculator::refresh() {
     DateTime start_date = DateTime::Now(true);
     DateTime end_date(start_date.AddDays(5.0));
 
-    SGP4 satellite(Tle("ESTCUBE 1",
-                  "1 39161U 13021C   14226.14653900  .00000766  00000-0  13565-3 0  3794",
-                  "2 39161  98.0947 306.6139 0009384 203.0001 157.0783 14.70096049 68114"));
-
     // Generate passes
-    passList = GeneratePassList(obsPosition, satellite, start_date, end_date, 180);
+    passList = GeneratePassList(observer, satellite, start_date, end_date, 180);
 
     emit listUpdated(passList);
 }
 
 void PassCalculator::setObserversPosition(const CoordGeodetic &geo) {
-    obsPosition = geo;
+    observer.SetLocation(geo);
 }
 
 void PassCalculator::setMiniumElevation(double elev) {
     miniumElevation = elev;
 }
 
-DateTime PassCalculator::FindCrossingPoint(const CoordGeodetic& user_geo, SGP4& sgp4, DateTime time1, DateTime time2, bool finding_aos)
-{
-    Observer obs(user_geo);
+void PassCalculator::catalogChanged(const Catalog& catalog, const Catalog::ChangeSet& changes) {
+    size_t index;
+    if (!changes.Contains(noradNumber) || !catalog.Find(noradNumber, index))
+        return;
+
+    satellite = catalog.Satellite(index);
+    refresh();
+}
 
+DateTime PassCalculator::FindCrossingPoint(const Observer& obs, const Propagator& propagator, DateTime time1, DateTime time2, bool finding_aos)
+{
     bool running;
     int cnt;
 
@@ -50,10 +64,9 @@ DateTime PassCalculator::FindCrossingPoint(const CoordGeodetic& user_geo, SGP4&
         /*
          * calculate satellite position
          */
-        Eci eci = sgp4.FindPosition(middle_time);
-        CoordTopocentric topo = obs.GetLookAngle(eci);
+        Eci eci = propagator.FindPosition(middle_time);
 
-        if (topo.elevation > 0.0)
+        if (obs.IsAboveElevation(eci, TimeContext(middle_time)))
         {
             /*
              * satellite above horizon
@@ -104,9 +117,8 @@ DateTime PassCalculator::FindCrossingPoint(const CoordGeodetic& user_geo, SGP4&
     cnt = 0;
     while (running && cnt++ < 6)
     {
-        Eci eci = sgp4.FindPosition(middle_time);
-        CoordTopocentric topo = obs.GetLookAngle(eci);
-        if (topo.elevation > 0)
+        Eci eci = propagator.FindPosition(middle_time);
+        if (obs.IsAboveElevation(eci, TimeContext(middle_time)))
         {
             middle_time = middle_time.AddSeconds(finding_aos ? -1 : 1);
         }
@@ -120,137 +132,208 @@ DateTime PassCalculator::FindCrossingPoint(const CoordGeodetic& user_geo, SGP4&
 }
 
 QList<PassDetails> PassCalculator::GeneratePassList(
-        const CoordGeodetic& user_geo,
+        const Observer& obs,
         SGP4& sgp4,
         const DateTime& start_time,
         const DateTime& end_time,
         const int time_step)
 {
-    QList<struct PassDetails> pass_list;
+    return GeneratePassLists(std::vector<Observer>(1, obs), sgp4, start_time, end_time, time_step).front();
+}
 
-    Observer obs(user_geo);
+namespace
+{
+    /*
+     * Stations sharing a search before a Chebyshev fit of the span is
+     * cheaper than searching against SGP4, measured over five days of a
+     * LEO satellite
+     */
+    const size_t kMinStationsForFit = 8;
 
-    DateTime aos_time;
-    DateTime los_time;
+    /*
+     * Where a station is in its search
+     */
+    struct StationSearch
+    {
+        StationSearch() : found_aos(false) {}
+
+        bool found_aos;
+        DateTime aos_time;
+        DateTime previous_time;
+        DateTime skip_until;
+    };
+}
 
-    bool found_aos = false;
+QList<QList<PassDetails> > PassCalculator::GeneratePassLists(
+        const QList<CoordGeodetic>& stations,
+        SGP4& sgp4,
+        const DateTime& start_time,
+        const DateTime& end_time,
+        const int time_step)
+{
+    std::vector<Observer> observers;
+
+    foreach(const CoordGeodetic& geo, stations) {
+        observers.push_back(Observer(geo));
+    }
+
+    return GeneratePassLists(observers, sgp4, start_time, end_time, time_step);
+}
+
+QList<QList<PassDetails> > PassCalculator::GeneratePassLists(
+        const std::vector<Observer>& observers,
+        SGP4& sgp4,
+        const DateTime& start_time,
+        const DateTime& end_time,
+        const int time_step)
+{
+    /*
+     * a fit costs about as much as the searches of a few stations
+     * against SGP4, so it is only made when enough stations share it
+     */
+    if (observers.size() >= kMinStationsForFit)
+    {
+        const ChebyshevEphemeris ephemeris(sgp4, start_time, end_time);
+        return SearchPasses(observers, ephemeris, start_time, end_time, time_step);
+    }
+
+    return SearchPasses(observers, sgp4, start_time, end_time, time_step);
+}
+
+QList<QList<PassDetails> > PassCalculator::SearchPasses(
+        const std::vector<Observer>& observers,
+        const Propagator& propagator,
+        const DateTime& start_time,
+        const DateTime& end_time,
+        const int time_step)
+{
+    QList<QList<PassDetails> > pass_lists;
+    std::vector<StationSearch> searches(observers.size());
+
+    for (size_t n = 0; n < observers.size(); n++)
+    {
+        pass_lists.append(QList<PassDetails>());
+    }
+
+    for (size_t n = 0; n < searches.size(); n++)
+    {
+        searches[n].previous_time = start_time;
+        searches[n].skip_until = start_time;
+    }
+
+    /*
+     * the coarse search times, propagated together in one call
+     */
+    const TimeGrid grid(start_time, end_time, TimeSpan(0, 0, time_step));
 
-    DateTime previous_time(start_time);
-    DateTime current_time(start_time);
+    std::vector<Eci> positions;
+    propagator.FindPositions(grid, positions);
 
-    while (current_time < end_time)
+    for (size_t i = 0; i < grid.Count(); i++)
     {
-        bool end_of_pass = false;
+        const TimeContext context = grid.Context(i);
+        const DateTime& current_time = context.GetDateTime();
 
         /*
-         * calculate satellite position
+         * every station is tested against this one position
          */
-        Eci eci = sgp4.FindPosition(current_time);
-        CoordTopocentric topo = obs.GetLookAngle(eci);
 
-        if (!found_aos && topo.elevation > 0.0)
+        for (size_t n = 0; n < searches.size(); n++)
         {
-            /*
-             * aos hasnt occured yet, but the satellite is now above horizon
-             * this must have occured within the last time_step
-             */
-            if (start_time == current_time)
+            StationSearch& search = searches[n];
+
+            if (current_time < search.skip_until)
             {
                 /*
-                 * satellite was already above the horizon at the start,
-                 * so use the start time
+                 * at the end of a pass the next 30mins are skipped
                  */
-                aos_time = start_time;
+                continue;
             }
-            else
+
+            const bool visible = observers[n].IsAboveElevation(positions[i], context);
+
+            if (!search.found_aos && visible)
             {
                 /*
-                 * find the point at which the satellite crossed the horizon
+                 * aos hasnt occured yet, but the satellite is now above horizon
+                 * this must have occured within the last time_step
                  */
-                aos_time = FindCrossingPoint( user_geo,
-                        sgp4,
-                        previous_time,
-                        current_time,
-                        true);
+                if (start_time == current_time)
+                {
+                    /*
+                     * satellite was already above the horizon at the start,
+                     * so use the start time
+                     */
+                    search.aos_time = start_time;
+                }
+                else
+                {
+                    /*
+                     * find the point at which the satellite crossed the horizon
+                     */
+                    search.aos_time = FindCrossingPoint(observers[n],
+                            propagator,
+                            search.previous_time,
+                            current_time,
+                            true);
+                }
+                search.found_aos = true;
             }
-            found_aos = true;
-        }
-        else if (found_aos && topo.elevation < 0.0)
-        {
-            found_aos = false;
-            /*
-             * end of pass, so move along more than time_step
-             */
-            end_of_pass = true;
-            /*
-             * already have the aos, but now the satellite is below the horizon,
-             * so find the los
-             */
-            los_time = FindCrossingPoint(user_geo, sgp4,
-                    previous_time,
-                    current_time,
-                    false);
-
-            struct PassDetails pd;
-            pd.aos = aos_time;
-            pd.los = los_time;
-            pd.max_elevation = FindMaxElevation(user_geo, sgp4, aos_time, los_time);
+            else if (search.found_aos && !visible)
+            {
+                search.found_aos = false;
+                /*
+                 * end of pass, so move along more than time_step
+                 */
+                search.skip_until = current_time + TimeSpan(0, 30, 0);
+                /*
+                 * already have the aos, but now the satellite is below the horizon,
+                 * so find the los
+                 */
+                const DateTime los_time = FindCrossingPoint(observers[n], propagator,
+                        search.previous_time,
+                        current_time,
+                        false);
 
-            if(RAD2DEG * pd.max_elevation >= miniumElevation)
-                pass_list.push_back(pd);
-        }
+                struct PassDetails pd;
+                pd.aos = search.aos_time;
+                pd.los = los_time;
+                pd.max_elevation = FindMaxElevation(observers[n], propagator, search.aos_time, los_time);
 
-        /*
-         * save current time
-         */
-        previous_time = current_time;
+                if(RAD2DEG * pd.max_elevation >= miniumElevation)
+                    pass_lists[n].push_back(pd);
+            }
 
-        if (end_of_pass)
-        {
-            /*
-             * at the end of the pass move the time along by 30mins
-             */
-            current_time = current_time + TimeSpan(0, 30, 0);
-        }
-        else
-        {
             /*
-             * move the time along by the time step value
+             * save current time
              */
-            current_time = current_time + TimeSpan(0, 0, time_step);
+            search.previous_time = current_time;
         }
+    }
 
-        if (current_time > end_time)
+    for (size_t n = 0; n < searches.size(); n++)
+    {
+        if (searches[n].found_aos)
         {
             /*
-             * dont go past end time
+             * satellite still above horizon at end of search period, so use end
+             * time as los
              */
-            current_time = end_time;
-        }
-    }
-
-    if (found_aos)
-    {
-        /*
-         * satellite still above horizon at end of search period, so use end
-         * time as los
-         */
-        struct PassDetails pd;
-        pd.aos = aos_time;
-        pd.los = end_time;
-        pd.max_elevation = FindMaxElevation(user_geo, sgp4, aos_time, end_time);
+            struct PassDetails pd;
+            pd.aos = searches[n].aos_time;
+            pd.los = end_time;
+            pd.max_elevation = FindMaxElevation(observers[n], propagator, searches[n].aos_time, end_time);
 
-        if(pd.max_elevation >= miniumElevation)
-            pass_list.push_back(pd);
+            if(RAD2DEG * pd.max_elevation >= miniumElevation)
+                pass_lists[n].push_back(pd);
+        }
     }
 
-    return pass_list;
+    return pass_lists;
 }
 
 
-double PassCalculator::FindMaxElevation(const CoordGeodetic& user_geo, SGP4& sgp4, const DateTime& aos, const DateTime& los) {
-
-    Observer obs(user_geo);
+double PassCalculator::FindMaxElevation(const Observer& obs, const Propagator& propagator, const DateTime& aos, const DateTime& los) {
 
     bool running;
 
@@ -271,8 +354,8 @@ double PassCalculator::FindMaxElevation(const CoordGeodetic& user_geo, SGP4& sgp
             /*
              * find position
              */
-            Eci eci = sgp4.FindPosition(current_time);
-            CoordTopocentric topo = obs.GetLookAngle(eci);
+            Eci eci = propagator.FindPosition(current_time);
+            CoordTopocentric topo = obs.GetLookAngle(Ecef(eci, TimeContext(current_time)));
 
             if (topo.elevation > max_elevation)
             {
@@ -4,6 +4,11 @@
 #include <QObject>
 #include "PassDetails.h"
 #include "Satellite.h"
+#include "Propagator.h"
+#include "Observer.h"
+#include "Catalog.h"
+
+#include <vector>
 
 class PassCalculator : public QObject
 {
@@ -11,6 +16,14 @@ class PassCalculator : public QObject
 public:
     explicit PassCalculator(QObject *parent = 0);
 
+    /*
+     * Search the passes of one satellite over many stations. The satellite
+     * is propagated once per time step and every station is checked from
+     * that one position; crossings are refined per station only where it
+     * sees the satellite rise or set. Returns one list per station, in the
+     * order given.
+     */
+    QList<QList<PassDetails> > GeneratePassLists(const QList<CoordGeodetic>& stations, SGP4& sgp4, const DateTime& start_time, const DateTime& end_time, const int time_step);
 
 
 signals:
@@ -23,19 +36,29 @@ public slots:
     void refresh();
     void setObserversPosition(const CoordGeodetic &geo);
     void setMiniumElevation(double elev);
+    void catalogChanged(const Catalog& catalog, const Catalog::ChangeSet& changes);
 
 private:
 
     QList<PassDetails> passList;
 
-    CoordGeodetic obsPosition;
+    // Initialised once and replaced only when the catalog updates it
+    SGP4 satellite;
+    unsigned int noradNumber;
+
+    // Kept as an Observer so its earth fixed frame is computed once, here
+    Observer observer;
     double miniumElevation;
 
-    double FindMaxElevation(const CoordGeodetic& user_geo, SGP4& sgp4, const DateTime& aos, const DateTime& los);
+    double FindMaxElevation(const Observer& obs, const Propagator& propagator, const DateTime& aos, const DateTime& los);
+
+    DateTime FindCrossingPoint(const Observer& obs, const Propagator& propagator, DateTime time1,DateTime time2,bool finding_aos);
+
+    QList<PassDetails> GeneratePassList(const Observer& obs, SGP4& sgp4, const DateTime& start_time, const DateTime& end_time, const int time_step);
 
-    DateTime FindCrossingPoint(const CoordGeodetic& user_geo, SGP4& sgp4, DateTime time1,DateTime time2,bool finding_aos);
+    QList<QList<PassDetails> > GeneratePassLists(const std::vector<Observer>& observers, SGP4& sgp4, const DateTime& start_time, const DateTime& end_time, const int time_step);
 
-    QList<PassDetails> GeneratePassList(const CoordGeodetic& user_geo, SGP4& sgp4, const DateTime& start_time, const DateTime& end_time, const int time_step);
+    QList<QList<PassDetails> > SearchPasses(const std::vector<Observer>& observers, const Propagator& propagator, const DateTime& start_time, const DateTime& end_time, const int time_step);
 
 
 };
@@ -7,6 +7,8 @@
 #include "Satellite.h"
 #include "SolarPosition.h"
 
+#include <vector>
+
 #define RAD2DEG (180.0/M_PI)
 #define DEG2RAD (M_PI/180.0)
 #define MIN(a,b) (((a)<(b))?(a):(b))
@@ -61,6 +63,17 @@ void QSimpleSatelliteMap::setObserversPosition(const CoordGeodetic& geo) {
     obsPosition = geo;
 }
 
+void QSimpleSatelliteMap::catalogChanged(const Catalog& catalog, const Catalog::ChangeSet& changes) {
+    // Satellites left out of the catalog keep their last elements
+    for (int i = 0; i < satellites.size(); i++) {
+        size_t index;
+        if (changes.Contains(satellites[i].noradNumber()) && catalog.Find(satellites[i].noradNumber(), index))
+            satellites[i].setPropagator(catalog.GetTle(index), catalog.Satellite(index));
+    }
+
+    update();
+}
+
 
 void QSimpleSatelliteMap::computeFootprint(const CoordGeodetic& geo) {
     double r0 = 6353.0; // ephem.earth_radius
@@ -156,11 +169,14 @@ void QSimpleSatelliteMap::paintEvent(QPaintEvent *) {
 
     qDebug() << now.Ticks();
 
+    // Earth orientation for this frame, shared by every satellite
+    const TimeContext context(now);
+
     foreach(const Satellite& satellite, satellites) {
 
         drawPath(painter, satellite);
 
-        CoordGeodetic geo = satellite.FindPosition(now).ToGeodetic();
+        CoordGeodetic geo = satellite.FindPosition(now).ToGeodetic(context);
 
         computeFootprint(geo);
         drawFootprint(painter);
@@ -184,17 +200,26 @@ void QSimpleSatelliteMap::drawPath(QPainter& painter, const SGP4& sat) {
 
     double period = 98; // minutes :TODO: Hardcoded value for ESTCube-1!
 
-    DateTime tims = DateTime::Now(true).AddMinutes(-period);
-    CoordGeodetic geo = sat.FindPosition(tims).ToGeodetic();
+    // Propagate the whole track in one go, one point per minute. Pixel
+    // accuracy is enough here, so use the fast visual tier
+    const TimeGrid grid(DateTime::Now(true).AddMinutes(-period), TimeSpan(0, 1, 0), 3*period);
+
+    std::vector<Eci> positions;
+    sat.FindPositions(grid, positions, SGP4Kernel::PRECISION_VISUAL);
+
+    std::vector<CoordGeodetic> geos;
+    Eci::ToGeodetic(positions, grid, geos);
+
+    CoordGeodetic geo = geos.front();
     CoordGeodetic prevGeo = geo;
 
     QPainterPath path;
     painter.setPen(trackColor);
     path.moveTo(latLonToXy(geo));
 
-    for(int i = 0; i < 3*period; i++ ) {
+    for(size_t i = 0; i < geos.size(); i++ ) {
 
-        geo = sat.FindPosition(tims).ToGeodetic();
+        geo = geos[i];
 
         // Flip?
         if( prevGeo.longitude < 0 && geo.longitude > 0) {
@@ -206,7 +231,6 @@ void QSimpleSatelliteMap::drawPath(QPainter& painter, const SGP4& sat) {
 
         path.lineTo(latLonToXy(geo));
 
-        tims = tims.AddMinutes(1);
         prevGeo = geo;
     }
 
@@ -10,6 +10,7 @@
 #include "CoordGeodetic.h"
 #include "Observer.h"
 #include "SGP4.h"
+#include "Catalog.h"
 
 #include "Satellite.h"
 
@@ -26,6 +27,7 @@ public:
 public slots:
 
     void setObserversPosition(const CoordGeodetic& geo);
+    void catalogChanged(const Catalog& catalog, const Catalog::ChangeSet& changes);
 
 protected:
 
@@ -13,13 +13,16 @@ class Satellite : public SGP4
 
 public:
 
-    Satellite(const Tle& tle, QString name = "") :
-        SGP4(tle),
+    Satellite(const Tle& tle, QString name = "",
+              Initialisation init = INITIALISE_NOW) :
+        SGP4(tle, init),
         mName(name),
-        mNORADID(tle.Name().c_str())
+        mNameFromTle(name.isEmpty()),
+        mNORADID(QString::number(tle.NoradNumber())),
+        mNoradNumber(tle.NoradNumber())
     {
-        if(name.isEmpty())
-            name = tle.Name().c_str();
+        if(mNameFromTle)
+            mName = tle.Name().c_str();
 
     }
 
@@ -29,8 +32,21 @@ public:
 
     const QString NORADId() const { return mNORADID; }
 
+    unsigned int noradNumber() const { return mNoradNumber; }
+
     const CoordGeodetic& latestPosition() const { return latestPos; }
 
+    // Replace the propagator with one initialised elsewhere, e.g. by a
+    // Catalog, from tle. The NORAD id, and a name taken from the tle,
+    // follow the new elements
+    void setPropagator(const Tle& tle, const SGP4& sgp4) {
+        SGP4::operator=(sgp4);
+        if(mNameFromTle)
+            mName = tle.Name().c_str();
+        mNORADID = QString::number(tle.NoradNumber());
+        mNoradNumber = tle.NoradNumber();
+    }
+
     void update() {
         DateTime now = DateTime::Now(true);
         Eci eci = FindPosition(now);
@@ -41,7 +57,9 @@ public:
 private:
 
     QString mName;
+    bool mNameFromTle;
     QString mNORADID;
+    unsigned int mNoradNumber;
 
     CoordGeodetic latestPos;
 };
@@ -0,0 +1,1227 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Catalog.h"
+
+#include "OrbitalElements.h"
+#include "Threading.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iterator>
+
+/*
+ * POSIX systems map the file, elsewhere it is read into memory
+ */
+#if defined(__unix__) || defined(__APPLE__)
+#define SGP4_CATALOG_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /*
+     * bytes of text per unit of work, about 900 three line records
+     */
+    static const size_t kChunkSize = 64 * 1024;
+
+    /*
+     * a line of text without its terminator, [begin, end)
+     */
+    struct Line
+    {
+        const char* begin;
+        const char* end;
+    };
+
+    /*
+     * the line starting at begin
+     */
+    Line LineAt(const char* begin, const char* limit)
+    {
+        const void* newline = memchr(begin, '\n', limit - begin);
+
+        Line line;
+        line.begin = begin;
+        line.end = newline ? static_cast<const char*>(newline) : limit;
+        return line;
+    }
+
+    bool NextLine(const Line& line, const char* limit, Line& next)
+    {
+        if (line.end == limit || line.end + 1 == limit)
+        {
+            return false;
+        }
+        next = LineAt(line.end + 1, limit);
+        return true;
+    }
+
+    bool PreviousLine(const Line& line, const char* data, Line& previous)
+    {
+        if (line.begin == data)
+        {
+            return false;
+        }
+
+        previous.end = line.begin - 1;
+        previous.begin = previous.end;
+        while (previous.begin != data && previous.begin[-1] != '\n')
+        {
+            previous.begin--;
+        }
+        return true;
+    }
+
+    bool IsSpace(const char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    /*
+     * the line without leading and trailing white space
+     */
+    Line Trim(Line line)
+    {
+        while (line.begin != line.end && IsSpace(line.begin[0]))
+        {
+            line.begin++;
+        }
+        while (line.end != line.begin && IsSpace(line.end[-1]))
+        {
+            line.end--;
+        }
+        return line;
+    }
+
+    bool IsBlank(const Line& line)
+    {
+        const Line trimmed = Trim(line);
+        return trimmed.begin == trimmed.end;
+    }
+
+    /*
+     * whether the line is tle line one or two, by its "1 " or "2 " start
+     */
+    bool IsElementLine(const Line& line, const char number)
+    {
+        return line.end - line.begin >= 2
+            && line.begin[0] == number
+            && line.begin[1] == ' ';
+    }
+
+    bool IsName(const Line& line)
+    {
+        return !IsBlank(line)
+            && !IsElementLine(line, '1')
+            && !IsElementLine(line, '2');
+    }
+
+    /*
+     * whether the line is line one, followed by line two
+     */
+    bool IsRecordStart(const Line& line, const char* limit)
+    {
+        Line next;
+        return IsElementLine(line, '1')
+            && NextLine(line, limit, next)
+            && IsElementLine(next, '2');
+    }
+
+    std::string ElementString(const Line& line)
+    {
+        const Line trimmed = Trim(line);
+        return std::string(trimmed.begin, trimmed.end);
+    }
+
+    std::string NameString(const Line& line)
+    {
+        Line trimmed = Trim(line);
+        if (trimmed.end - trimmed.begin >= 2
+                && trimmed.begin[0] == '0'
+                && trimmed.begin[1] == ' ')
+        {
+            trimmed.begin += 2;
+            trimmed = Trim(trimmed);
+        }
+        return std::string(trimmed.begin, trimmed.end);
+    }
+
+    /*
+     * the records whose first line starts in [begin, end). lines are
+     * counted from the start of the chunk, Load() moves them to the file
+     */
+    struct Chunk
+    {
+        const char* begin;
+        const char* end;
+        unsigned int lines;
+        std::vector<Tle> tles;
+        std::vector<SGP4> satellites;
+        std::vector<Catalog::Error> errors;
+    };
+
+    /*
+     * the chunks Load() shares between its threads
+     */
+    struct ChunkQueue
+    {
+        const char* data;
+        const char* limit;
+        std::vector<Chunk>* chunks;
+        Threading::AtomicCounter next;
+        /*
+         * the catalog being refreshed, NULL for a load
+         */
+        const Catalog* previous;
+    };
+
+    /*
+     * whether two element sets of a satellite are the same. the epoch
+     * is compared too, for sources which do not number their sets
+     */
+    bool IsSameElementSet(const Tle& tle1, const Tle& tle2)
+    {
+        return tle1.ElementNumber() == tle2.ElementNumber()
+            && tle1.Epoch() == tle2.Epoch();
+    }
+
+    /*
+     * append from to to, moving the elements where the language allows,
+     * and free from
+     */
+    template <class T>
+    void Append(std::vector<T>& to, std::vector<T>& from)
+    {
+#if __cplusplus >= 201103L
+        to.insert(to.end(),
+                std::make_move_iterator(from.begin()),
+                std::make_move_iterator(from.end()));
+#else
+        to.insert(to.end(), from.begin(), from.end());
+#endif
+        std::vector<T>().swap(from);
+    }
+
+    void AddError(Chunk& chunk, const unsigned int line, const char* message)
+    {
+        Catalog::Error error;
+        error.line = line;
+        error.message = message;
+        chunk.errors.push_back(error);
+    }
+
+    void ParseChunk(const ChunkQueue& queue, Chunk& chunk)
+    {
+        const char* begin = chunk.begin;
+
+        /*
+         * a line straddling the start belongs to the chunk before
+         */
+        if (begin != queue.data && begin[-1] != '\n')
+        {
+            const void* newline = memchr(begin, '\n', chunk.end - begin);
+            if (newline == NULL)
+            {
+                return;
+            }
+            begin = static_cast<const char*>(newline) + 1;
+        }
+
+        /*
+         * each line is classified by its neighbours, which may be in
+         * another chunk
+         */
+        for (const char* p = begin; p < chunk.end; )
+        {
+            const Line line = LineAt(p, queue.limit);
+            const unsigned int line_number = chunk.lines++;
+            Line previous;
+            Line next;
+
+            if (IsRecordStart(line, queue.limit))
+            {
+                NextLine(line, queue.limit, next);
+
+                std::string name;
+                unsigned int first_line = line_number;
+                if (PreviousLine(line, queue.data, previous)
+                        && IsName(previous))
+                {
+                    name = NameString(previous);
+                    first_line--;
+                }
+
+                try
+                {
+                    const Tle tle(name,
+                            ElementString(line),
+                            ElementString(next));
+
+                    size_t index;
+                    if (queue.previous != NULL
+                            && queue.previous->Find(tle.NoradNumber(), index)
+                            && IsSameElementSet(
+                                queue.previous->GetTle(index), tle))
+                    {
+                        /*
+                         * unchanged, so copied rather than initialised
+                         */
+                        chunk.satellites.push_back(
+                                queue.previous->Satellite(index));
+                    }
+                    else
+                    {
+                        chunk.satellites.push_back(SGP4(tle));
+                    }
+                    chunk.tles.push_back(tle);
+                }
+                catch (const std::exception& e)
+                {
+                    AddError(chunk, first_line, e.what());
+                }
+            }
+            else if (IsElementLine(line, '2')
+                    && PreviousLine(line, queue.data, previous)
+                    && IsElementLine(previous, '1'))
+            {
+                /*
+                 * line two of the record before
+                 */
+            }
+            else if (IsName(line)
+                    && NextLine(line, queue.limit, next)
+                    && IsRecordStart(next, queue.limit))
+            {
+                /*
+                 * name of the record after
+                 */
+            }
+            else if (IsElementLine(line, '1'))
+            {
+                AddError(chunk, line_number, "Line one without line two");
+            }
+            else if (IsElementLine(line, '2'))
+            {
+                AddError(chunk, line_number, "Line two without line one");
+            }
+            else if (!IsBlank(line))
+            {
+                AddError(chunk, line_number, "Name without a tle");
+            }
+
+            if (line.end == queue.limit)
+            {
+                break;
+            }
+            p = line.end + 1;
+        }
+    }
+
+    void* ChunkThread(void* arg)
+    {
+        ChunkQueue* queue = static_cast<ChunkQueue*>(arg);
+        std::vector<Chunk>& chunks = *queue->chunks;
+
+        for (size_t i = queue->next.Next();
+                i < chunks.size();
+                i = queue->next.Next())
+        {
+            ParseChunk(*queue, chunks[i]);
+        }
+
+        return NULL;
+    }
+
+    /*
+     * binary images. the version changes with the meaning of the fields,
+     * the sizes in the header catch a change of their layout
+     */
+    static const char kImageMagic[8] = {'S', 'G', 'P', '4', 'C', 'A', 'T', 0};
+    static const unsigned int kImageVersion = 2;
+    static const unsigned int kImageByteOrder = 0x01020304;
+    static const unsigned int kNoDeepSpace = 0xffffffff;
+
+    /*
+     * 64 bit FNV-1a, taken a word at a time rather than a byte, which
+     * is as good at catching corruption and eight times fewer steps
+     */
+    static const unsigned long long kChecksumBasis = 14695981039346656037ULL;
+
+    unsigned long long Checksum(
+            unsigned long long hash,
+            const void* data,
+            const size_t size)
+    {
+        static const unsigned long long kPrime = 1099511628211ULL;
+
+        const char* bytes = static_cast<const char*>(data);
+        size_t i = 0;
+        for (; i + sizeof(unsigned long long) <= size;
+                i += sizeof(unsigned long long))
+        {
+            unsigned long long word;
+            memcpy(&word, bytes + i, sizeof(word));
+            hash = (hash ^ word) * kPrime;
+        }
+        for (; i < size; i++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(bytes[i])) * kPrime;
+        }
+        return hash;
+    }
+
+    /*
+     * write a whole buffer, false on error
+     */
+    bool Write(FILE* file, const void* data, const size_t size)
+    {
+        return size == 0 || fwrite(data, size, 1, file) == 1;
+    }
+
+#ifdef SGP4_CATALOG_MMAP
+    /*
+     * a read only mapping of a whole file, unmapped on destruction
+     */
+    class FileMapping
+    {
+    public:
+        FileMapping()
+            : data_(MAP_FAILED),
+            size_(0)
+        {
+        }
+
+        ~FileMapping()
+        {
+            if (data_ != MAP_FAILED)
+            {
+                munmap(data_, size_);
+            }
+        }
+
+        /*
+         * returns 0, or the errno of the failure
+         */
+        int Map(const std::string& filename)
+        {
+            const int fd = open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                return errno;
+            }
+
+            struct stat status;
+            if (fstat(fd, &status) != 0)
+            {
+                const int error = errno;
+                close(fd);
+                return error;
+            }
+
+            /*
+             * an empty file cannot be mapped, and needs not be
+             */
+            size_ = static_cast<size_t>(status.st_size);
+            if (size_ == 0)
+            {
+                close(fd);
+                return 0;
+            }
+
+            data_ = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            const int error = errno;
+            close(fd);
+
+            if (data_ == MAP_FAILED)
+            {
+                return error;
+            }
+
+            madvise(data_, size_, MADV_WILLNEED);
+            return 0;
+        }
+
+        const char* Data() const
+        {
+            return data_ == MAP_FAILED ? NULL : static_cast<const char*>(data_);
+        }
+
+        size_t Size() const
+        {
+            return size_;
+        }
+
+    private:
+        FileMapping(const FileMapping&);
+        FileMapping& operator=(const FileMapping&);
+
+        void* data_;
+        size_t size_;
+    };
+#else
+    /*
+     * a whole file read into memory, where it cannot be mapped
+     */
+    class FileMapping
+    {
+    public:
+        FileMapping()
+        {
+        }
+
+        /*
+         * returns 0, or the errno of the failure
+         */
+        int Map(const std::string& filename)
+        {
+            FILE* file = fopen(filename.c_str(), "rb");
+            if (file == NULL)
+            {
+                return errno;
+            }
+
+            char buffer[65536];
+            size_t read;
+            while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            {
+                data_.insert(data_.end(), buffer, buffer + read);
+            }
+
+            const bool failed = ferror(file) != 0;
+            fclose(file);
+
+            return failed ? EIO : 0;
+        }
+
+        const char* Data() const
+        {
+            return data_.empty() ? NULL : &data_[0];
+        }
+
+        size_t Size() const
+        {
+            return data_.size();
+        }
+
+    private:
+        FileMapping(const FileMapping&);
+        FileMapping& operator=(const FileMapping&);
+
+        std::vector<char> data_;
+    };
+#endif
+}
+
+bool Catalog::LoadFile(const std::string& filename, unsigned int threads)
+{
+    FileMapping mapping;
+    const int error = mapping.Map(filename);
+    if (error != 0)
+    {
+        errors_.clear();
+        FileError(filename, strerror(error));
+        return false;
+    }
+
+    Load(mapping.Data(), mapping.Size(), threads);
+    return true;
+}
+
+void Catalog::Load(const char* data, size_t size, unsigned int threads)
+{
+    Catalog next;
+    next.Parse(data, size, threads, NULL);
+    next.BuildIndex();
+
+    ChangeSet changes;
+    Adopt(next, changes);
+}
+
+bool Catalog::RefreshFile(
+        const std::string& filename,
+        ChangeSet& changes,
+        unsigned int threads)
+{
+    FileMapping mapping;
+    const int error = mapping.Map(filename);
+    if (error != 0)
+    {
+        changes.version = version_;
+        changes.added.clear();
+        changes.updated.clear();
+        changes.removed.clear();
+
+        errors_.clear();
+        FileError(filename, strerror(error));
+        return false;
+    }
+
+    Refresh(mapping.Data(), mapping.Size(), changes, threads);
+    return true;
+}
+
+void Catalog::Refresh(
+        const char* data,
+        size_t size,
+        ChangeSet& changes,
+        unsigned int threads)
+{
+    Catalog next;
+    next.Parse(data, size, threads, this);
+    next.BuildIndex();
+
+    Adopt(next, changes);
+}
+
+/*
+ * take the contents of next, which is left with the old ones, and list
+ * what that changed. the version is only incremented if something did
+ */
+void Catalog::Adopt(Catalog& next, ChangeSet& changes)
+{
+    changes.added.clear();
+    changes.updated.clear();
+    changes.removed.clear();
+
+    /*
+     * both indexes are sorted, so the lists come out sorted. a satellite
+     * held more than once is compared by its first occurrence
+     */
+    for (size_t i = 0; i < next.index_.size(); i++)
+    {
+        const unsigned int norad_number = next.index_[i].first;
+        if (i > 0 && next.index_[i - 1].first == norad_number)
+        {
+            continue;
+        }
+
+        size_t index;
+        if (!Find(norad_number, index))
+        {
+            changes.added.push_back(norad_number);
+        }
+        else if (!IsSameElementSet(tles_[index],
+                    next.tles_[next.index_[i].second]))
+        {
+            changes.updated.push_back(norad_number);
+        }
+    }
+
+    for (size_t i = 0; i < index_.size(); i++)
+    {
+        const unsigned int norad_number = index_[i].first;
+        if (i > 0 && index_[i - 1].first == norad_number)
+        {
+            continue;
+        }
+
+        size_t index;
+        if (!next.Find(norad_number, index))
+        {
+            changes.removed.push_back(norad_number);
+        }
+    }
+
+    tles_.swap(next.tles_);
+    satellites_.swap(next.satellites_);
+    errors_.swap(next.errors_);
+    index_.swap(next.index_);
+
+    if (!changes.Empty())
+    {
+        version_++;
+    }
+    changes.version = version_;
+}
+
+bool Catalog::Find(unsigned int norad_number, size_t& index) const
+{
+    const std::vector<std::pair<unsigned int, size_t> >::const_iterator it =
+        std::lower_bound(index_.begin(), index_.end(),
+                std::make_pair(norad_number, static_cast<size_t>(0)));
+
+    if (it == index_.end() || it->first != norad_number)
+    {
+        return false;
+    }
+
+    index = it->second;
+    return true;
+}
+
+bool Catalog::ChangeSet::Contains(unsigned int norad_number) const
+{
+    return std::binary_search(added.begin(), added.end(), norad_number)
+        || std::binary_search(updated.begin(), updated.end(), norad_number)
+        || std::binary_search(removed.begin(), removed.end(), norad_number);
+}
+
+/*
+ * parse the text into the catalog, which is empty. satellites unchanged
+ * from previous, if given, are copied from it
+ */
+void Catalog::Parse(
+        const char* data,
+        size_t size,
+        unsigned int threads,
+        const Catalog* previous)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    std::vector<Chunk> chunks((size + kChunkSize - 1) / kChunkSize);
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        chunks[i].begin = data + i * kChunkSize;
+        chunks[i].end = data + std::min(size, (i + 1) * kChunkSize);
+        chunks[i].lines = 0;
+    }
+
+    size_t count = threads;
+    if (count == 0)
+    {
+        count = Threading::ProcessorCount();
+    }
+    count = std::min(count, chunks.size());
+
+    ChunkQueue queue;
+    queue.data = data;
+    queue.limit = data + size;
+    queue.chunks = &chunks;
+    queue.previous = previous;
+
+    /*
+     * this thread is one of the workers. if a thread cannot be started,
+     * or there are none, the others take its share
+     */
+    Threading::RunWorkers(&ChunkThread, &queue, count);
+
+    /*
+     * join the chunks in file order
+     */
+    size_t total = 0;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        total += chunks[i].satellites.size();
+    }
+    tles_.reserve(total);
+    satellites_.reserve(total);
+
+    unsigned int first_line = 1;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        Chunk& chunk = chunks[i];
+
+        Append(tles_, chunk.tles);
+        Append(satellites_, chunk.satellites);
+
+        for (size_t j = 0; j < chunk.errors.size(); j++)
+        {
+            chunk.errors[j].line += first_line;
+            errors_.push_back(chunk.errors[j]);
+        }
+        first_line += chunk.lines;
+    }
+}
+
+void Catalog::Clear()
+{
+    if (!tles_.empty())
+    {
+        version_++;
+    }
+
+    tles_.clear();
+    satellites_.clear();
+    errors_.clear();
+    index_.clear();
+}
+
+void Catalog::BuildIndex()
+{
+    index_.clear();
+    index_.reserve(tles_.size());
+    for (size_t i = 0; i < tles_.size(); i++)
+    {
+        index_.push_back(std::make_pair(tles_[i].NoradNumber(), i));
+    }
+    std::sort(index_.begin(), index_.end());
+}
+
+/*
+ * an image is the header, then the satellites, the deep space constants,
+ * the integrator checkpoints and the names, one after the other. each
+ * part is a whole number of 8 byte words, so the mapping keeps them all
+ * aligned
+ */
+struct Catalog::ImageHeader
+{
+    char magic[8];
+    /*
+     * of everything after the header
+     */
+    unsigned long long checksum;
+    unsigned int version;
+    unsigned int byte_order;
+    /*
+     * the record sizes of the build which wrote the image
+     */
+    unsigned int satellite_size;
+    unsigned int deepspace_size;
+    unsigned int checkpoint_size;
+    /*
+     * the number of records in each part, and the bytes of names
+     */
+    unsigned int satellites;
+    unsigned int deepspaces;
+    unsigned int checkpoints;
+    unsigned int names_size;
+    unsigned int reserved;
+};
+
+struct Catalog::SatelliteRecord
+{
+    /*
+     * the propagator
+     */
+    SGP4Kernel::NearSpaceLane lane;
+    int status;
+    unsigned char use_simple_model;
+    unsigned char use_deep_space;
+    /*
+     * index of the deep space record, kNoDeepSpace for near space
+     */
+    unsigned int deepspace;
+
+    /*
+     * the orbital elements
+     */
+    double mean_anomoly;
+    double ascending_node;
+    double argument_perigee;
+    double eccentricity;
+    double inclination;
+    double mean_motion;
+    double bstar;
+    double recovered_semi_major_axis;
+    double recovered_mean_motion;
+    double perigee;
+    double period;
+    long long epoch;
+
+    /*
+     * the tle, whose epoch is the one above
+     */
+    double tle_mean_motion_dt2;
+    double tle_mean_motion_ddt6;
+    double tle_bstar;
+    double tle_inclination;
+    double tle_right_ascending_node;
+    double tle_eccentricity;
+    double tle_argument_perigee;
+    double tle_mean_anomaly;
+    double tle_mean_motion;
+    unsigned int norad_number;
+    unsigned int orbit_number;
+    unsigned int element_number;
+    unsigned int name_offset;
+    unsigned int name_length;
+    char int_designator[8];
+    char line_one[69];
+    char line_two[69];
+};
+
+struct Catalog::DeepSpaceRecord
+{
+    SGP4::DeepSpaceConstants consts;
+    SGP4::IntegratorConstants integrator;
+    double a3ovk2;
+    /*
+     * the forward checkpoints, then as many backward
+     */
+    unsigned int first_checkpoint;
+    unsigned int checkpoints;
+};
+
+bool Catalog::SaveImage(const std::string& filename) const
+{
+    std::vector<SatelliteRecord> satellites(satellites_.size());
+    std::vector<DeepSpaceRecord> deepspaces;
+    std::vector<SGP4::IntegratorParams> checkpoints;
+    std::string names;
+
+    for (size_t i = 0; i < satellites_.size(); i++)
+    {
+        const Tle& tle = tles_[i];
+        const SGP4& sgp4 = satellites_[i];
+        const OrbitalElements& elements = sgp4.elements_;
+        SatelliteRecord& record = satellites[i];
+
+        sgp4.EnsureInitialised();
+
+        /*
+         * zeroed so the padding is, and the image depends on the
+         * catalog alone
+         */
+        memset(&record, 0, sizeof(record));
+
+        record.lane = sgp4.lane_;
+        record.status = sgp4.elements_status_;
+        record.use_simple_model = sgp4.use_simple_model_;
+        record.use_deep_space = sgp4.use_deep_space_;
+        record.deepspace = kNoDeepSpace;
+
+        record.mean_anomoly = elements.mean_anomoly_;
+        record.ascending_node = elements.ascending_node_;
+        record.argument_perigee = elements.argument_perigee_;
+        record.eccentricity = elements.eccentricity_;
+        record.inclination = elements.inclination_;
+        record.mean_motion = elements.mean_motion_;
+        record.bstar = elements.bstar_;
+        record.recovered_semi_major_axis = elements.recovered_semi_major_axis_;
+        record.recovered_mean_motion = elements.recovered_mean_motion_;
+        record.perigee = elements.perigee_;
+        record.period = elements.period_;
+        record.epoch = elements.epoch_.Ticks();
+
+        record.tle_mean_motion_dt2 = tle.mean_motion_dt2_;
+        record.tle_mean_motion_ddt6 = tle.mean_motion_ddt6_;
+        record.tle_bstar = tle.bstar_;
+        record.tle_inclination = tle.inclination_;
+        record.tle_right_ascending_node = tle.right_ascending_node_;
+        record.tle_eccentricity = tle.eccentricity_;
+        record.tle_argument_perigee = tle.argument_perigee_;
+        record.tle_mean_anomaly = tle.mean_anomaly_;
+        record.tle_mean_motion = tle.mean_motion_;
+        record.norad_number = tle.norad_number_;
+        record.orbit_number = tle.orbit_number_;
+        record.element_number = tle.element_number_;
+        record.name_offset = static_cast<unsigned int>(names.size());
+        record.name_length = static_cast<unsigned int>(tle.name_.size());
+        names += tle.name_;
+        tle.int_designator_.copy(record.int_designator,
+                sizeof(record.int_designator));
+        tle.line_one_.copy(record.line_one, sizeof(record.line_one));
+        tle.line_two_.copy(record.line_two, sizeof(record.line_two));
+
+        if (sgp4.use_deep_space_)
+        {
+            DeepSpaceRecord deepspace;
+            memset(&deepspace, 0, sizeof(deepspace));
+
+            deepspace.consts = sgp4.deepspace_->consts;
+            deepspace.integrator = sgp4.deepspace_->integrator;
+            deepspace.a3ovk2 = sgp4.deepspace_->a3ovk2;
+            deepspace.first_checkpoint =
+                static_cast<unsigned int>(checkpoints.size());
+            deepspace.checkpoints =
+                static_cast<unsigned int>(sgp4.deepspace_->forward.size());
+
+            checkpoints.insert(checkpoints.end(),
+                    sgp4.deepspace_->forward.begin(),
+                    sgp4.deepspace_->forward.end());
+            checkpoints.insert(checkpoints.end(),
+                    sgp4.deepspace_->backward.begin(),
+                    sgp4.deepspace_->backward.end());
+
+            record.deepspace = static_cast<unsigned int>(deepspaces.size());
+            deepspaces.push_back(deepspace);
+        }
+    }
+
+    names.resize((names.size() + 7) & ~static_cast<size_t>(7), '\0');
+
+    ImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kImageMagic, sizeof(header.magic));
+    header.version = kImageVersion;
+    header.byte_order = kImageByteOrder;
+    header.satellite_size = sizeof(SatelliteRecord);
+    header.deepspace_size = sizeof(DeepSpaceRecord);
+    header.checkpoint_size = sizeof(SGP4::IntegratorParams);
+    header.satellites = static_cast<unsigned int>(satellites.size());
+    header.deepspaces = static_cast<unsigned int>(deepspaces.size());
+    header.checkpoints = static_cast<unsigned int>(checkpoints.size());
+    header.names_size = static_cast<unsigned int>(names.size());
+
+    /*
+     * an empty vector has no element to take the address of
+     */
+    const SatelliteRecord* satellite_data =
+        satellites.empty() ? NULL : &satellites[0];
+    const DeepSpaceRecord* deepspace_data =
+        deepspaces.empty() ? NULL : &deepspaces[0];
+    const SGP4::IntegratorParams* checkpoint_data =
+        checkpoints.empty() ? NULL : &checkpoints[0];
+    const size_t satellite_bytes = satellites.size() * sizeof(SatelliteRecord);
+    const size_t deepspace_bytes = deepspaces.size() * sizeof(DeepSpaceRecord);
+    const size_t checkpoint_bytes =
+        checkpoints.size() * sizeof(SGP4::IntegratorParams);
+
+    unsigned long long checksum = kChecksumBasis;
+    checksum = Checksum(checksum, satellite_data, satellite_bytes);
+    checksum = Checksum(checksum, deepspace_data, deepspace_bytes);
+    checksum = Checksum(checksum, checkpoint_data, checkpoint_bytes);
+    checksum = Checksum(checksum, names.data(), names.size());
+    header.checksum = checksum;
+
+    /*
+     * write beside the file and rename over it, so a reader never maps a
+     * partly written image
+     */
+    const std::string temporary = filename + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    bool written = Write(file, &header, sizeof(header))
+        && Write(file, satellite_data, satellite_bytes)
+        && Write(file, deepspace_data, deepspace_bytes)
+        && Write(file, checkpoint_data, checkpoint_bytes)
+        && Write(file, names.data(), names.size());
+    int error = errno;
+
+    if (fclose(file) != 0 && written)
+    {
+        written = false;
+        error = errno;
+    }
+
+    if (written && rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        written = false;
+        error = errno;
+    }
+
+    if (!written)
+    {
+        remove(temporary.c_str());
+        errno = error;
+    }
+
+    return written;
+}
+
+bool Catalog::LoadImage(const std::string& filename)
+{
+    Catalog next;
+    if (!next.ReadImage(filename))
+    {
+        errors_.swap(next.errors_);
+        return false;
+    }
+
+    ChangeSet changes;
+    Adopt(next, changes);
+    return true;
+}
+
+/*
+ * read an image into the catalog, which is empty
+ */
+bool Catalog::ReadImage(const std::string& filename)
+{
+    FileMapping mapping;
+    const int error = mapping.Map(filename);
+    if (error != 0)
+    {
+        FileError(filename, strerror(error));
+        return false;
+    }
+
+    const char* data = mapping.Data();
+    const size_t size = mapping.Size();
+
+    ImageHeader header;
+    if (size < sizeof(header))
+    {
+        FileError(filename, "Not a catalog image");
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, kImageMagic, sizeof(header.magic)) != 0)
+    {
+        FileError(filename, "Not a catalog image");
+        return false;
+    }
+
+    if (header.version != kImageVersion)
+    {
+        FileError(filename, "Unsupported catalog image version");
+        return false;
+    }
+
+    if (header.byte_order != kImageByteOrder
+            || header.satellite_size != sizeof(SatelliteRecord)
+            || header.deepspace_size != sizeof(DeepSpaceRecord)
+            || header.checkpoint_size != sizeof(SGP4::IntegratorParams))
+    {
+        FileError(filename, "Catalog image has a different layout");
+        return false;
+    }
+
+    const size_t satellite_bytes =
+        static_cast<size_t>(header.satellites) * sizeof(SatelliteRecord);
+    const size_t deepspace_bytes =
+        static_cast<size_t>(header.deepspaces) * sizeof(DeepSpaceRecord);
+    const size_t checkpoint_bytes = static_cast<size_t>(header.checkpoints)
+        * sizeof(SGP4::IntegratorParams);
+
+    if (size != sizeof(header) + satellite_bytes + deepspace_bytes
+            + checkpoint_bytes + header.names_size)
+    {
+        FileError(filename, "Catalog image has the wrong size");
+        return false;
+    }
+
+    if (Checksum(kChecksumBasis, data + sizeof(header), size - sizeof(header))
+            != header.checksum)
+    {
+        FileError(filename, "Catalog image checksum does not match");
+        return false;
+    }
+
+    const SatelliteRecord* satellites =
+        reinterpret_cast<const SatelliteRecord*>(data + sizeof(header));
+    const DeepSpaceRecord* deepspaces =
+        reinterpret_cast<const DeepSpaceRecord*>(
+                data + sizeof(header) + satellite_bytes);
+    const SGP4::IntegratorParams* checkpoints =
+        reinterpret_cast<const SGP4::IntegratorParams*>(
+                data + sizeof(header) + satellite_bytes + deepspace_bytes);
+    const char* names = data + sizeof(header) + satellite_bytes
+        + deepspace_bytes + checkpoint_bytes;
+
+    tles_.reserve(header.satellites);
+    satellites_.reserve(header.satellites);
+
+    for (unsigned int i = 0; i < header.satellites; i++)
+    {
+        const SatelliteRecord& record = satellites[i];
+
+        /*
+         * the checksum guards against corruption, not against a crafted
+         * image, so check every index before following it
+         */
+        const bool valid_name = record.name_offset <= header.names_size
+            && record.name_length <= header.names_size - record.name_offset;
+        const bool valid_deepspace = record.deepspace == kNoDeepSpace
+            || (record.deepspace < header.deepspaces
+                && deepspaces[record.deepspace].first_checkpoint
+                    <= header.checkpoints
+                && deepspaces[record.deepspace].checkpoints
+                    <= (header.checkpoints
+                        - deepspaces[record.deepspace].first_checkpoint) / 2);
+        if (!valid_name || !valid_deepspace
+                || (record.use_deep_space != 0)
+                    != (record.deepspace != kNoDeepSpace))
+        {
+            Clear();
+            FileError(filename, "Catalog image is corrupt");
+            return false;
+        }
+
+        const DateTime epoch(static_cast<unsigned long long>(record.epoch));
+
+        Tle tle;
+        tle.name_.assign(names + record.name_offset, record.name_length);
+        tle.line_one_.assign(record.line_one, sizeof(record.line_one));
+        tle.line_two_.assign(record.line_two, sizeof(record.line_two));
+        tle.norad_number_ = record.norad_number;
+        tle.int_designator_.assign(record.int_designator,
+                sizeof(record.int_designator));
+        tle.epoch_ = epoch;
+        tle.mean_motion_dt2_ = record.tle_mean_motion_dt2;
+        tle.mean_motion_ddt6_ = record.tle_mean_motion_ddt6;
+        tle.bstar_ = record.tle_bstar;
+        tle.inclination_ = record.tle_inclination;
+        tle.right_ascending_node_ = record.tle_right_ascending_node;
+        tle.eccentricity_ = record.tle_eccentricity;
+        tle.argument_perigee_ = record.tle_argument_perigee;
+        tle.mean_anomaly_ = record.tle_mean_anomaly;
+        tle.mean_motion_ = record.tle_mean_motion;
+        tle.orbit_number_ = record.orbit_number;
+        tle.element_number_ = record.element_number;
+
+        OrbitalElements elements;
+        elements.mean_anomoly_ = record.mean_anomoly;
+        elements.ascending_node_ = record.ascending_node;
+        elements.argument_perigee_ = record.argument_perigee;
+        elements.eccentricity_ = record.eccentricity;
+        elements.inclination_ = record.inclination;
+        elements.mean_motion_ = record.mean_motion;
+        elements.bstar_ = record.bstar;
+        elements.recovered_semi_major_axis_ = record.recovered_semi_major_axis;
+        elements.recovered_mean_motion_ = record.recovered_mean_motion;
+        elements.perigee_ = record.perigee;
+        elements.period_ = record.period;
+        elements.epoch_ = epoch;
+
+        tles_.push_back(tle);
+        satellites_.push_back(SGP4(elements));
+
+        SGP4& sgp4 = satellites_.back();
+        sgp4.lane_ = record.lane;
+        sgp4.elements_status_ = static_cast<SGP4Kernel::Status>(record.status);
+        sgp4.use_simple_model_ = record.use_simple_model != 0;
+        sgp4.use_deep_space_ = record.use_deep_space != 0;
+
+        if (sgp4.use_deep_space_)
+        {
+            const DeepSpaceRecord& deepspace = deepspaces[record.deepspace];
+            const SGP4::IntegratorParams* forward =
+                checkpoints + deepspace.first_checkpoint;
+            const SGP4::IntegratorParams* backward =
+                forward + deepspace.checkpoints;
+
+            sgp4.deepspace_.Reset(new SGP4::DeepSpaceData);
+            sgp4.deepspace_->consts = deepspace.consts;
+            sgp4.deepspace_->integrator = deepspace.integrator;
+            sgp4.deepspace_->a3ovk2 = deepspace.a3ovk2;
+            sgp4.deepspace_->forward.assign(forward,
+                    forward + deepspace.checkpoints);
+            sgp4.deepspace_->backward.assign(backward,
+                    backward + deepspace.checkpoints);
+        }
+
+        sgp4.ChoosePropagator();
+        sgp4.initialised_.SetDone(true);
+    }
+
+    BuildIndex();
+    return true;
+}
+
+void Catalog::FileError(const std::string& filename, const std::string& message)
+{
+    Error error;
+    error.line = 0;
+    error.message = filename + ": " + message;
+    errors_.push_back(error);
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CATALOG_H_
+#define CATALOG_H_
+
+#include "Tle.h"
+#include "SGP4.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A catalog of satellites loaded from tle text.
+ *
+ * Reads two line (2LE) and three line (3LE) element sets, mixed freely,
+ * as published by CelesTrak and Space-Track. A name line may carry the
+ * "0 " prefix of Space-Track. Files are memory mapped, or read where they
+ * cannot be, and cut into chunks which are split into records, parsed and
+ * initialised on several threads, or on one where there are none. The
+ * satellites keep the order of the file.
+ *
+ * A record that fails to parse or initialise is left out and its error
+ * is collected, with the line it starts on, rather than thrown.
+ *
+ * A loaded catalog can be saved as a binary image, which holds the tles
+ * and the computed constants of the propagators in flat arrays. Loading
+ * an image maps it and copies the constants into place, without parsing
+ * or initialising anything.
+ *
+ * Refreshing from a new element set keeps the propagators of the
+ * satellites whose element set is unchanged and initialises the rest.
+ * The change set it returns names the satellites, by norad number, that
+ * were added, updated or removed, so that whatever was derived from them
+ * can be recomputed for those alone. Every load that changes the
+ * contents increments the version of the catalog.
+ */
+class Catalog
+{
+public:
+    /**
+     * @brief Why a record was left out.
+     */
+    struct Error
+    {
+        /** the line the record starts on, counting from 1. 0 for the file */
+        unsigned int line;
+        /** what was wrong */
+        std::string message;
+    };
+
+    /**
+     * @brief What a refresh changed, by norad number.
+     *
+     * A satellite is updated when its element set number or its epoch
+     * differ, so sources which do not number their element sets are
+     * still followed.
+     */
+    struct ChangeSet
+    {
+        /** the version of the catalog after the refresh */
+        unsigned int version;
+        /** satellites new to the catalog */
+        std::vector<unsigned int> added;
+        /** satellites with a new element set */
+        std::vector<unsigned int> updated;
+        /** satellites no longer in the catalog */
+        std::vector<unsigned int> removed;
+
+        /**
+         * @returns whether nothing changed
+         */
+        bool Empty() const
+        {
+            return added.empty() && updated.empty() && removed.empty();
+        }
+
+        /**
+         * @param[in] norad_number the satellite
+         * @returns whether the satellite was added, updated or removed
+         */
+        bool Contains(unsigned int norad_number) const;
+    };
+
+    Catalog()
+        : version_(0)
+    {
+    }
+
+    virtual ~Catalog()
+    {
+    }
+
+    /**
+     * Replace the catalog with the contents of a file. If the file cannot
+     * be read the catalog is kept as it was
+     * @param[in] filename the file to read
+     * @param[in] threads the number of threads to use, 0 for one per
+     * processor
+     * @returns false if the file could not be read, which is the only
+     * error then
+     */
+    bool LoadFile(const std::string& filename, unsigned int threads = 0);
+
+    /**
+     * Replace the catalog with the contents of a buffer
+     * @param[in] data the tle text, need not be null terminated
+     * @param[in] size the length of the text in bytes
+     * @param[in] threads the number of threads to use, 0 for one per
+     * processor
+     */
+    void Load(const char* data, size_t size, unsigned int threads = 0);
+
+    /**
+     * Refresh the catalog from a file, keeping the satellites which did
+     * not change. If the file cannot be read the catalog is kept as it
+     * was
+     * @param[in] filename the file to read
+     * @param[out] changes what changed
+     * @param[in] threads the number of threads to use, 0 for one per
+     * processor
+     * @returns false if the file could not be read, which is the only
+     * error then
+     */
+    bool RefreshFile(
+            const std::string& filename,
+            ChangeSet& changes,
+            unsigned int threads = 0);
+
+    /**
+     * Refresh the catalog from a buffer, keeping the satellites which did
+     * not change
+     * @param[in] data the tle text, need not be null terminated
+     * @param[in] size the length of the text in bytes
+     * @param[out] changes what changed
+     * @param[in] threads the number of threads to use, 0 for one per
+     * processor
+     */
+    void Refresh(
+            const char* data,
+            size_t size,
+            ChangeSet& changes,
+            unsigned int threads = 0);
+
+    /**
+     * Write the catalog as a binary image. The file is replaced only once
+     * the image is complete
+     * @param[in] filename the file to write
+     * @returns false if the file could not be written, with errno set
+     */
+    bool SaveImage(const std::string& filename) const;
+
+    /**
+     * Replace the catalog with a binary image written by SaveImage(). The
+     * image must come from a build with the same version and layout of
+     * the constants, and its checksum must match. If the image cannot be
+     * read or is rejected the catalog is kept as it was
+     * @param[in] filename the file to read
+     * @returns false if the image could not be read or was rejected,
+     * which is the only error then
+     */
+    bool LoadImage(const std::string& filename);
+
+    /**
+     * Remove all satellites and errors. The version is incremented if
+     * there were satellites
+     */
+    void Clear();
+
+    /**
+     * @returns the version of the contents, incremented by every load,
+     * refresh or clear which changes them. The contents are the element
+     * sets by norad number, as a refresh compares them
+     */
+    unsigned int Version() const
+    {
+        return version_;
+    }
+
+    /**
+     * Find a satellite by its norad number
+     * @param[in] norad_number the satellite
+     * @param[out] index the index of the satellite, the first if the
+     * catalog holds it more than once
+     * @returns whether the catalog holds the satellite
+     */
+    bool Find(unsigned int norad_number, size_t& index) const;
+
+    /**
+     * @returns the number of satellites loaded
+     */
+    size_t Size() const
+    {
+        return satellites_.size();
+    }
+
+    /**
+     * @param[in] i the index of the satellite
+     * @returns the tle of the satellite
+     */
+    const Tle& GetTle(size_t i) const
+    {
+        return tles_[i];
+    }
+
+    /**
+     * @param[in] i the index of the satellite
+     * @returns the initialised propagator of the satellite
+     */
+    const SGP4& Satellite(size_t i) const
+    {
+        return satellites_[i];
+    }
+
+    /**
+     * @returns the initialised propagators, in the order of the file
+     */
+    const std::vector<SGP4>& Satellites() const
+    {
+        return satellites_;
+    }
+
+    /**
+     * @returns the records left out of the last load, in the order of
+     * the file
+     */
+    const std::vector<Error>& Errors() const
+    {
+        return errors_;
+    }
+
+private:
+    struct ImageHeader;
+    struct SatelliteRecord;
+    struct DeepSpaceRecord;
+
+    void Parse(
+            const char* data,
+            size_t size,
+            unsigned int threads,
+            const Catalog* previous);
+    void Adopt(Catalog& next, ChangeSet& changes);
+    bool ReadImage(const std::string& filename);
+    void BuildIndex();
+    void FileError(const std::string& filename, const std::string& message);
+
+    std::vector<Tle> tles_;
+    std::vector<SGP4> satellites_;
+    std::vector<Error> errors_;
+
+    /*
+     * (norad number, index) sorted, for Find()
+     */
+    std::vector<std::pair<unsigned int, size_t> > index_;
+    unsigned int version_;
+};
+
+#endif
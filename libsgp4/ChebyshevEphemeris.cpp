@@ -0,0 +1,257 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ChebyshevEphemeris.h"
+
+#include "Globals.h"
+#include "Vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+
+const int ChebyshevEphemeris::kDegree;
+const int ChebyshevEphemeris::kNodes;
+
+/**
+ * Evaluate a Chebyshev series with Clenshaw's recurrence
+ * @param[in] c the coefficients, c[0] already halved
+ * @param[in] n the number of coefficients
+ * @param[in] x the point, -1 <= x <= 1
+ * @returns the value of the series
+ */
+static inline double EvaluateChebyshev(
+        const double* c,
+        const int n,
+        const double x)
+{
+    const double x2 = 2.0 * x;
+    double b1 = 0.0;
+    double b2 = 0.0;
+
+    for (int j = n - 1; j > 0; j--)
+    {
+        const double b0 = c[j] + x2 * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+
+    return c[0] + x * b1 - b2;
+}
+
+ChebyshevEphemeris::ChebyshevEphemeris(
+        const SGP4& sgp4,
+        const DateTime& start,
+        const DateTime& end,
+        const double window,
+        const double tolerance)
+    : sgp4_(sgp4),
+    start_(start),
+    end_(end),
+    window_(window),
+    tolerance_(tolerance)
+{
+    const double span = (end_ - start_).TotalMinutes();
+
+    if (span > 0.0 && window_ > 0.0)
+    {
+        windows_.resize(static_cast<size_t>(ceil(span / window_)));
+
+        for (size_t i = 0; i < windows_.size(); i++)
+        {
+            Fit(i);
+        }
+    }
+}
+
+Eci ChebyshevEphemeris::FindPosition(const DateTime& date) const
+{
+    double x;
+    const Window* w = FindWindow(date, x);
+
+    if (w == NULL)
+    {
+        return sgp4_.FindPosition(date);
+    }
+
+    return Eci(date,
+            Vector(EvaluateChebyshev(w->coefficients[0], kNodes, x),
+                EvaluateChebyshev(w->coefficients[1], kNodes, x),
+                EvaluateChebyshev(w->coefficients[2], kNodes, x)),
+            Vector(EvaluateChebyshev(w->coefficients[3], kNodes, x),
+                EvaluateChebyshev(w->coefficients[4], kNodes, x),
+                EvaluateChebyshev(w->coefficients[5], kNodes, x)));
+}
+
+void ChebyshevEphemeris::FindPositions(
+        const std::vector<DateTime>& dates,
+        std::vector<Eci>& positions) const
+{
+    positions.clear();
+    positions.reserve(dates.size());
+
+    for (size_t i = 0; i < dates.size(); i++)
+    {
+        positions.push_back(FindPosition(dates[i]));
+    }
+}
+
+void ChebyshevEphemeris::FindPositions(
+        const TimeGrid& grid,
+        std::vector<Eci>& positions,
+        const SGP4Kernel::Precision) const
+{
+    positions.clear();
+    positions.reserve(grid.Count());
+
+    for (size_t i = 0; i < grid.Count(); i++)
+    {
+        positions.push_back(FindPosition(grid.At(i)));
+    }
+}
+
+double ChebyshevEphemeris::ErrorBound(const DateTime& date) const
+{
+    double x;
+    const Window* w = FindWindow(date, x);
+
+    return w == NULL ? -1.0 : w->error;
+}
+
+/**
+ * Fit one window
+ * @param[in] index the window to fit
+ */
+void ChebyshevEphemeris::Fit(const size_t index)
+{
+    Window& w = windows_[index];
+
+    /*
+     * window bounds in minutes since epoch, the last window may be short
+     */
+    const double offset = (start_ - sgp4_.elements_.Epoch()).TotalMinutes();
+    const double span = (end_ - start_).TotalMinutes();
+    const double a = offset + index * window_;
+    const double b = offset + std::min((index + 1) * window_, span);
+    const double mid = 0.5 * (a + b);
+    const double half = 0.5 * (b - a);
+
+    /*
+     * sample at the nodes, then check at the extrema of T(kNodes) which
+     * lie between the nodes and at both ends
+     */
+    std::vector<double> tsince;
+    for (int k = 0; k < kNodes; k++)
+    {
+        tsince.push_back(mid + half * cos(kPI * (k + 0.5) / kNodes));
+    }
+    for (int k = 0; k <= kNodes; k++)
+    {
+        tsince.push_back(mid + half * cos(kPI * k / kNodes));
+    }
+
+    std::vector<Eci> samples;
+
+    try
+    {
+        sgp4_.FindPositions(tsince, samples);
+    }
+    catch (const std::exception&)
+    {
+        /*
+         * decayed or invalid inside the window, leave it to SGP4
+         */
+        w.error = -1.0;
+        return;
+    }
+
+    for (int j = 0; j < kNodes; j++)
+    {
+        double sum[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+        for (int k = 0; k < kNodes; k++)
+        {
+            const double t = cos(kPI * j * (k + 0.5) / kNodes);
+            const Vector p = samples[k].Position();
+            const Vector v = samples[k].Velocity();
+
+            sum[0] += p.x * t;
+            sum[1] += p.y * t;
+            sum[2] += p.z * t;
+            sum[3] += v.x * t;
+            sum[4] += v.y * t;
+            sum[5] += v.z * t;
+        }
+
+        const double scale = (j == 0 ? 1.0 : 2.0) / kNodes;
+
+        for (int axis = 0; axis < 6; axis++)
+        {
+            w.coefficients[axis][j] = sum[axis] * scale;
+        }
+    }
+
+    w.error = 0.0;
+
+    for (int k = 0; k <= kNodes; k++)
+    {
+        const double x = cos(kPI * k / kNodes);
+        const Vector p = samples[kNodes + k].Position();
+        Vector fit(EvaluateChebyshev(w.coefficients[0], kNodes, x),
+                EvaluateChebyshev(w.coefficients[1], kNodes, x),
+                EvaluateChebyshev(w.coefficients[2], kNodes, x));
+
+        w.error = std::max(w.error, (fit - p).Magnitude());
+    }
+
+    if (w.error > tolerance_)
+    {
+        w.error = -1.0;
+    }
+}
+
+/**
+ * @param[in] date the time to find
+ * @param[out] x the position of the time within the window, -1 to 1
+ * @returns the window containing date, or NULL if SGP4 should be used
+ */
+const ChebyshevEphemeris::Window* ChebyshevEphemeris::FindWindow(
+        const DateTime& date,
+        double& x) const
+{
+    if (windows_.empty() || date < start_ || date > end_)
+    {
+        return NULL;
+    }
+
+    const double span = (end_ - start_).TotalMinutes();
+    const double t = (date - start_).TotalMinutes();
+    const size_t index = std::min(static_cast<size_t>(t / window_),
+            windows_.size() - 1);
+
+    const Window& w = windows_[index];
+    if (w.error < 0.0)
+    {
+        return NULL;
+    }
+
+    const double a = index * window_;
+    const double b = std::min((index + 1) * window_, span);
+    x = (2.0 * t - a - b) / (b - a);
+
+    return &w;
+}
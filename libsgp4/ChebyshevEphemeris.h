@@ -0,0 +1,140 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CHEBYSHEVEPHEMERIS_H_
+#define CHEBYSHEVEPHEMERIS_H_
+
+#include "SGP4.h"
+#include "Propagator.h"
+#include "DateTime.h"
+#include "Eci.h"
+#include "TimeGrid.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Piecewise Chebyshev fit of SGP4 output over a time span.
+ *
+ * The span is split into windows of equal length. In each window the
+ * position and velocity are fitted with a Chebyshev series sampled from
+ * SGP4 at the Chebyshev nodes. The fit is then checked against SGP4
+ * between the nodes; windows whose position error exceeds the tolerance,
+ * and times outside the span, fall back to SGP4::FindPosition().
+ *
+ * Evaluating a window is a few multiply-adds per axis, but fitting costs
+ * 27 SGP4 evaluations per window, about 6500 for five days of 30 minute
+ * windows. A fit only pays off when it answers many more queries than
+ * that, e.g. a pass search over several stations. The ephemeris is not
+ * modified by queries, so it can be shared by many threads.
+ */
+class ChebyshevEphemeris : public Propagator
+{
+public:
+    /**
+     * Fit the ephemeris
+     * @param[in] sgp4 the satellite
+     * @param[in] start the start of the span
+     * @param[in] end the end of the span
+     * @param[in] window the window length in minutes, e.g. 30 for LEO
+     * @param[in] tolerance the largest position error in km a window may
+     * have before it falls back to SGP4
+     */
+    ChebyshevEphemeris(
+            const SGP4& sgp4,
+            const DateTime& start,
+            const DateTime& end,
+            const double window = 30.0,
+            const double tolerance = 1.0e-3);
+
+    virtual ~ChebyshevEphemeris()
+    {
+    }
+
+    /**
+     * @param[in] date the time to find the position for
+     * @returns the position
+     */
+    Eci FindPosition(const DateTime& date) const;
+
+    /**
+     * @param[in] dates the times to find the positions for
+     * @param[out] positions the positions, one per date
+     */
+    void FindPositions(
+            const std::vector<DateTime>& dates,
+            std::vector<Eci>& positions) const;
+
+    /**
+     * @param[in] grid the times to find the positions for
+     * @param[out] positions the positions, one per time
+     * @param[in] precision unused, the fit is exact to within its
+     * tolerance
+     */
+    void FindPositions(
+            const TimeGrid& grid,
+            std::vector<Eci>& positions,
+            const SGP4Kernel::Precision precision
+                = SGP4Kernel::PRECISION_EXACT) const;
+
+    /**
+     * @param[in] date the time to check
+     * @returns the largest position error in km found when fitting the
+     * window containing date, or a negative value if the time is
+     * answered by SGP4
+     */
+    double ErrorBound(const DateTime& date) const;
+
+    /**
+     * @returns the satellite used for fitting and fallback
+     */
+    const SGP4& Satellite() const
+    {
+        return sgp4_;
+    }
+
+private:
+    /*
+     * the degree of the series, and the number of nodes sampled
+     */
+    static const int kDegree = 12;
+    static const int kNodes = kDegree + 1;
+
+    struct Window
+    {
+        /*
+         * largest position error, km. negative when not usable
+         */
+        double error;
+        /*
+         * coefficients for x, y, z position then x, y, z velocity
+         */
+        double coefficients[6][kNodes];
+    };
+
+    void Fit(const size_t index);
+    const Window* FindWindow(const DateTime& date, double& x) const;
+
+    SGP4 sgp4_;
+    DateTime start_;
+    DateTime end_;
+    double window_;
+    double tolerance_;
+    std::vector<Window> windows_;
+};
+
+#endif
@@ -68,39 +68,6 @@ public:
         altitude = alt;
     }
 
-    /**
-     * Copy constructor
-     * @param[in] geo object to copy from
-     */
-    CoordGeodetic(const CoordGeodetic& geo)
-    {
-        latitude = geo.latitude;
-        longitude = geo.longitude;
-        altitude = geo.altitude;
-    }
-
-    /**
-     * Destructor
-     */
-    virtual ~CoordGeodetic()
-    {
-    }
-
-    /**
-     * Assignment operator
-     * @param[in] geo object to copy from
-     */
-    CoordGeodetic& operator=(const CoordGeodetic& geo)
-    {
-        if (this != &geo)
-        {
-            latitude = geo.latitude;
-            longitude = geo.longitude;
-            altitude = geo.altitude;
-        }
-        return *this;
-    }
-
     /**
      * Equality operator
      * @param[in] geo the object to compare with
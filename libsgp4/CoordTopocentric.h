@@ -38,7 +38,7 @@ public:
      * Default constructor
      */
     CoordTopocentric()
-        : azimuth(0.0), 
+        : azimuth(0.0),
         elevation(0.0),
         range(0.0),
         range_rate(0.0)
@@ -64,41 +64,6 @@ public:
     {
     }
 
-    /**
-     * Copy constructor
-     * @param[in] topo object to copy from
-     */
-    CoordTopocentric(const CoordTopocentric& topo)
-    {
-        azimuth = topo.azimuth;
-        elevation = topo.elevation;
-        range = topo.range;
-        range_rate = topo.range_rate;
-    }
-
-    /**
-     * Destructor
-     */
-    virtual ~CoordTopocentric()
-    {
-    }
-
-    /**
-     * Assignment operator
-     * @param[in] topo object to copy from
-     */
-    CoordTopocentric& operator=(const CoordTopocentric& topo)
-    {
-        if (this != &topo)
-        {
-            azimuth = topo.azimuth;
-            elevation = topo.elevation;
-            range = topo.range;
-            range_rate = topo.range_rate;
-        }
-        return *this;
-    }
-
     /**
      * Equality operator
      * @param[in] topo value to check
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ECEF_H_
+#define ECEF_H_
+
+#include "Eci.h"
+#include "Globals.h"
+#include "TimeContext.h"
+#include "Vector.h"
+
+/**
+ * @brief Stores an Earth-centered Earth-fixed position for a particular time.
+ *
+ * The frame rotates with the earth about the z axis by the greenwich mean
+ * sidereal time, so ground stations are constant vectors in it. Rotate a
+ * satellite state into it once, then evaluate it against any number of
+ * observers with Observer::GetLookAngle(const Ecef&).
+ */
+class Ecef
+{
+public:
+    /**
+     * Rotate an inertial state into the earth fixed frame
+     * @param[in] eci the inertial position and velocity
+     * @param[in] context the time of eci
+     */
+    Ecef(const Eci& eci, const TimeContext& context)
+        : m_dt(context.GetDateTime())
+    {
+        static const double mfactor = kTWOPI * (kOMEGA_E / kSECONDS_PER_DAY);
+
+        const double sin_gmst = context.SinGreenwichSiderealTime();
+        const double cos_gmst = context.CosGreenwichSiderealTime();
+        const Vector pos = eci.Position();
+        const Vector vel = eci.Velocity();
+
+        m_position.x = cos_gmst * pos.x + sin_gmst * pos.y;
+        m_position.y = -sin_gmst * pos.x + cos_gmst * pos.y;
+        m_position.z = pos.z;
+
+        /*
+         * less the velocity of the frame itself
+         */
+        m_velocity.x = cos_gmst * vel.x + sin_gmst * vel.y
+            + mfactor * m_position.y;
+        m_velocity.y = -sin_gmst * vel.x + cos_gmst * vel.y
+            - mfactor * m_position.x;
+        m_velocity.z = vel.z;
+    }
+
+    /**
+     * @returns the position in km
+     */
+    Vector Position() const
+    {
+        return m_position;
+    }
+
+    /**
+     * @returns the velocity relative to the rotating earth in km/s
+     */
+    Vector Velocity() const
+    {
+        return m_velocity;
+    }
+
+    /**
+     * @returns the date
+     */
+    DateTime GetDateTime() const
+    {
+        return m_dt;
+    }
+
+private:
+    DateTime m_dt;
+    Vector m_position;
+    Vector m_velocity;
+};
+
+#endif
@@ -18,14 +18,123 @@
 #include "Eci.h"
 
 #include "Globals.h"
+#include "TimeGrid.h"
 #include "Util.h"
 
+#include <cmath>
+
+/**
+ * Geodetic latitude and altitude of a position, without iterating
+ * (Vermeille, "Direct transformation from geocentric coordinates to
+ * geodetic coordinates", Journal of Geodesy, 2002). Accurate to well below
+ * a millimetre for any position more than about 43 km from the centre of
+ * the earth; closer in the formula does not hold.
+ * @param[in] x the x position in km
+ * @param[in] y the y position in km
+ * @param[in] z the z position in km
+ * @param[out] lat the geodetic latitude in radians
+ * @param[out] alt the altitude in km
+ * @returns false if the position is too close to the centre of the earth
+ */
+static inline bool ToGeodeticClosedForm(
+        const double x,
+        const double y,
+        const double z,
+        double& lat,
+        double& alt)
+{
+    static const double e2 = kF * (2.0 - kF);
+    static const double e4 = e2 * e2;
+    static const double inv_a2 = 1.0 / (kXKMPER * kXKMPER);
+
+    const double rho2 = x * x + y * y;
+
+    const double p = rho2 * inv_a2;
+    const double q = (1.0 - e2) * inv_a2 * z * z;
+    const double r = (p + q - e4) / 6.0;
+
+    /*
+     * keep the arithmetic finite inside the evolute, the result there is
+     * replaced by the caller
+     */
+    const bool valid = r > 0.0;
+    const double rr = valid ? r : 1.0;
+
+    const double s = e4 * p * q / (4.0 * rr * rr * rr);
+    const double t = cbrt(1.0 + s + sqrt(s * (2.0 + s)));
+    const double u = rr * (1.0 + t + 1.0 / t);
+    const double v = sqrt(u * u + e4 * q);
+    const double w = e2 * (u + v - q) / (2.0 * v);
+    const double k = sqrt(u + v + w * w) - w;
+    const double d = k * sqrt(rho2) / (k + e2);
+    const double dz = sqrt(d * d + z * z);
+
+    lat = 2.0 * atan2(z, d + dz);
+    alt = (k + e2 - 1.0) / k * dz;
+
+    return valid;
+}
+
+/**
+ * Geodetic latitude and altitude of a position, by fixed point iteration
+ * @param[in] x the x position in km
+ * @param[in] y the y position in km
+ * @param[in] z the z position in km
+ * @param[out] lat the geodetic latitude in radians
+ * @param[out] alt the altitude in km
+ */
+static void ToGeodeticIterative(
+        const double x,
+        const double y,
+        const double z,
+        double& lat,
+        double& alt)
+{
+    const double r = sqrt((x * x) + (y * y));
+    
+    static const double e2 = kF * (2.0 - kF);
+
+    lat = Util::AcTan(z, r);
+    double phi = 0.0;
+    double c = 0.0;
+    int cnt = 0;
+
+    do
+    {
+        phi = lat;
+        const double sinphi = sin(phi);
+        c = 1.0 / sqrt(1.0 - e2 * sinphi * sinphi);
+        lat = Util::AcTan(z + kXKMPER * c * e2 * sinphi, r);
+        cnt++;
+    }
+    while (fabs(lat - phi) >= 1e-10 && cnt < 10);
+
+    alt = r / cos(lat) - kXKMPER * c;
+}
+
 /**
  * Converts a DateTime and Geodetic position to Eci coordinates
  * @param[in] dt the date
  * @param[in] geo the geodetic position
  */
 void Eci::ToEci(const DateTime& dt, const CoordGeodetic &geo)
+{
+    /*
+     * Calculate Local Mean Sidereal Time for observers longitude
+     */
+    ToEci(dt, dt.ToLocalMeanSiderealTime(geo.longitude), geo);
+}
+
+/**
+ * Converts a DateTime and Geodetic position to Eci coordinates
+ * @param[in] dt the date
+ * @param[in] theta the local mean sidereal time at the position
+ * @param[in] geo the geodetic position
+ */
+void Eci::ToEci(
+        const DateTime& dt,
+        const double theta,
+        const CoordGeodetic &geo)
 {
     /*
      * set date
@@ -34,11 +143,6 @@ void Eci::ToEci(const DateTime& dt, const CoordGeodetic &geo)
 
     static const double mfactor = kTWOPI * (kOMEGA_E / kSECONDS_PER_DAY);
 
-    /*
-     * Calculate Local Mean Sidereal Time for observers longitude
-     */
-    const double theta = m_dt.ToLocalMeanSiderealTime(geo.longitude);
-
     /*
      * take into account earth flattening
      */
@@ -51,56 +155,136 @@ void Eci::ToEci(const DateTime& dt, const CoordGeodetic &geo)
      * X position in km
      * Y position in km
      * Z position in km
-     * W magnitude in km
      */
     m_position.x = achcp * cos(theta);
     m_position.y = achcp * sin(theta);
     m_position.z = (kXKMPER * s + geo.altitude) * sin(geo.latitude);
-    m_position.w = m_position.Magnitude();
 
     /*
      * X velocity in km/s
      * Y velocity in km/s
      * Z velocity in km/s
-     * W magnitude in km/s
      */
     m_velocity.x = -mfactor * m_position.y;
     m_velocity.y = mfactor * m_position.x;
     m_velocity.z = 0.0;
-    m_velocity.w = m_velocity.Magnitude();
 }
 
 /**
  * @returns the position in geodetic form
  */
 CoordGeodetic Eci::ToGeodetic() const
+{
+    return ToGeodetic(m_dt.ToGreenwichSiderealTime());
+}
+
+/**
+ * @param[in] gmst the greenwich mean sidereal time of this position
+ * @returns the position in geodetic form
+ */
+CoordGeodetic Eci::ToGeodetic(const double gmst) const
 {
     const double theta = Util::AcTan(m_position.y, m_position.x);
 
-    const double lon = Util::WrapNegPosPI(theta
-            - m_dt.ToGreenwichSiderealTime());
+    const double lon = Util::WrapNegPosPI(theta - gmst);
 
-    const double r = sqrt((m_position.x * m_position.x)
-            + (m_position.y * m_position.y));
-    
-    static const double e2 = kF * (2.0 - kF);
+    double lat;
+    double alt;
 
-    double lat = Util::AcTan(m_position.z, r);
-    double phi = 0.0;
-    double c = 0.0;
-    int cnt = 0;
+    if (!ToGeodeticClosedForm(m_position.x, m_position.y, m_position.z,
+                lat, alt))
+    {
+        ToGeodeticIterative(m_position.x, m_position.y, m_position.z,
+                lat, alt);
+    }
 
-    do
+    return CoordGeodetic(lat, lon, alt, true);
+}
+
+void Eci::ToGeodetic(
+        const std::vector<Eci>& positions,
+        std::vector<CoordGeodetic>& geos)
+{
+    std::vector<double> gmst(positions.size());
+
+    for (size_t i = 0; i < positions.size(); i++)
     {
-        phi = lat;
-        const double sinphi = sin(phi);
-        c = 1.0 / sqrt(1.0 - e2 * sinphi * sinphi);
-        lat = Util::AcTan(m_position.z + kXKMPER * c * e2 * sinphi, r);
-        cnt++;
+        gmst[i] = positions[i].m_dt.ToGreenwichSiderealTime();
     }
-    while (fabs(lat - phi) >= 1e-10 && cnt < 10);
 
-    const double alt = r / cos(lat) - kXKMPER * c;
+    ToGeodetic(positions, gmst, geos);
+}
 
-    return CoordGeodetic(lat, lon, alt, true);
+void Eci::ToGeodetic(
+        const std::vector<Eci>& positions,
+        const TimeGrid& grid,
+        std::vector<CoordGeodetic>& geos)
+{
+    std::vector<double> gmst(positions.size());
+
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        gmst[i] = grid.GreenwichSiderealTime(i);
+    }
+
+    ToGeodetic(positions, gmst, geos);
+}
+
+/**
+ * @param[in] positions the positions
+ * @param[in] gmst the greenwich mean sidereal time of each position
+ * @param[out] geos the positions in geodetic form
+ */
+void Eci::ToGeodetic(
+        const std::vector<Eci>& positions,
+        const std::vector<double>& gmst,
+        std::vector<CoordGeodetic>& geos)
+{
+    const size_t count = positions.size();
+
+    geos.clear();
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    /*
+     * gather the positions column wise, so that the conversion below is a
+     * straight loop over arrays without branches
+     */
+    std::vector<double> columns(5 * count);
+    std::vector<unsigned char> valid(count);
+    double* x = &columns[0];
+    double* y = x + count;
+    double* z = y + count;
+    double* lat = z + count;
+    double* alt = lat + count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        x[i] = positions[i].m_position.x;
+        y[i] = positions[i].m_position.y;
+        z[i] = positions[i].m_position.z;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        valid[i] = ToGeodeticClosedForm(x[i], y[i], z[i], lat[i], alt[i]);
+    }
+
+    geos.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!valid[i])
+        {
+            ToGeodeticIterative(x[i], y[i], z[i], lat[i], alt[i]);
+        }
+
+        const double theta = Util::AcTan(y[i], x[i]);
+
+        geos.push_back(CoordGeodetic(lat[i],
+                    Util::WrapNegPosPI(theta - gmst[i]), alt[i], true));
+    }
 }
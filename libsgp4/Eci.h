@@ -21,9 +21,16 @@
 #include "CoordGeodetic.h"
 #include "Vector.h"
 #include "DateTime.h"
+#include "TimeContext.h"
+
+class TimeGrid;
+
+#include <vector>
 
 /**
  * @brief Stores an Earth-centered inertial position for a particular time.
+ *
+ * Plain data: trivially copyable and standard layout, like Vector.
  */
 class Eci
 {
@@ -52,13 +59,24 @@ public:
         ToEci(dt, geo);
     }
 
+    /**
+     * @param[in] context the time to be used for this position
+     * @param[in] geo the position
+     */
+    Eci(const TimeContext& context, const CoordGeodetic& geo)
+    {
+        ToEci(context.GetDateTime(),
+                context.LocalMeanSiderealTime(geo.longitude), geo);
+    }
+
     /**
      * @param[in] dt the date to be used for this position
      * @param[in] position
      */
     Eci(const DateTime &dt, const Vector &position)
         : m_dt(dt),
-        m_position(position)
+        m_position(position),
+        m_velocity()
     {
     }
 
@@ -74,13 +92,6 @@ public:
     {
     }
 
-    /**
-     * Destructor
-     */
-    virtual ~Eci()
-    {
-    }
-
     /**
      * Equality operator
      * @param dt the date to compare
@@ -140,8 +151,51 @@ public:
      */
     CoordGeodetic ToGeodetic() const;
 
+    /**
+     * @param[in] context the time of this position
+     * @returns the position in geodetic form
+     */
+    CoordGeodetic ToGeodetic(const TimeContext& context) const
+    {
+        return ToGeodetic(context.GreenwichSiderealTime());
+    }
+
+    /**
+     * Convert many positions to geodetic form. The latitude and altitude
+     * are computed column wise in one branch free loop, which the compiler
+     * can vectorise (e.g. -O3 -ffast-math with a vector maths library,
+     * glibc's libmvec on x86_64). The results agree with ToGeodetic() to
+     * within 1e-9.
+     * @param[in] positions the positions, each at its own time
+     * @param[out] geos the positions in geodetic form, one per position
+     */
+    static void ToGeodetic(
+            const std::vector<Eci>& positions,
+            std::vector<CoordGeodetic>& geos);
+
+    /**
+     * Convert many positions to geodetic form, as above, taking the earth
+     * rotation of each position from the grid of times they were found for
+     * @param[in] positions the positions, one per time of grid
+     * @param[in] grid the times of the positions
+     * @param[out] geos the positions in geodetic form, one per position
+     */
+    static void ToGeodetic(
+            const std::vector<Eci>& positions,
+            const TimeGrid& grid,
+            std::vector<CoordGeodetic>& geos);
+
 private:
     void ToEci(const DateTime& dt, const CoordGeodetic& geo);
+    void ToEci(
+            const DateTime& dt,
+            const double theta,
+            const CoordGeodetic& geo);
+    CoordGeodetic ToGeodetic(const double gmst) const;
+    static void ToGeodetic(
+            const std::vector<Eci>& positions,
+            const std::vector<double>& gmst,
+            std::vector<CoordGeodetic>& geos);
 
     DateTime m_dt;
     Vector m_position;
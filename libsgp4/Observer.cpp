@@ -18,30 +18,244 @@
 #include "Observer.h"
 
 #include "CoordTopocentric.h"
+#include "Globals.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+ * the number of objects converted per block in GetLookAngles
+ */
+static const size_t kLookAngleBlock = 64;
+
+/*
+ * the observers position and local axes in the earth fixed frame, as
+ * Eci::ToEci with the sidereal time left out
+ */
+void Observer::UpdateFrame()
+{
+    const double sin_lat = sin(m_geo.latitude);
+    const double cos_lat = cos(m_geo.latitude);
+    const double sin_lon = sin(m_geo.longitude);
+    const double cos_lon = cos(m_geo.longitude);
+
+    const double c = 1.0 / sqrt(1.0 + kF * (kF - 2.0) * sin_lat * sin_lat);
+    const double s = (1.0 - kF) * (1.0 - kF) * c;
+    const double achcp = (kXKMPER * c + m_geo.altitude) * cos_lat;
+
+    m_ecef = Vector(achcp * cos_lon,
+            achcp * sin_lon,
+            (kXKMPER * s + m_geo.altitude) * sin_lat);
+    m_south = Vector(sin_lat * cos_lon, sin_lat * sin_lon, -cos_lat);
+    m_east = Vector(-sin_lon, cos_lon, 0.0);
+    m_up = Vector(cos_lat * cos_lon, cos_lat * sin_lon, sin_lat);
+}
+
+bool Observer::IsAboveElevation(
+        const Eci &eci,
+        const TimeContext& context,
+        const double sin_elevation) const
+{
+    const Vector pos = eci.Position();
+    const double sin_gmst = context.SinGreenwichSiderealTime();
+    const double cos_gmst = context.CosGreenwichSiderealTime();
+
+    /*
+     * only the position is needed, so rotate it here rather than through
+     * Ecef
+     */
+    return IsAboveElevation(Vector(cos_gmst * pos.x + sin_gmst * pos.y,
+                -sin_gmst * pos.x + cos_gmst * pos.y,
+                pos.z),
+            sin_elevation);
+}
+
+bool Observer::IsAboveElevation(
+        const Vector& position,
+        const double sin_elevation) const
+{
+    const double x = position.x - m_ecef.x;
+    const double y = position.y - m_ecef.y;
+    const double z = position.z - m_ecef.z;
+
+    /*
+     * sin(el) = up / |range| > sin_elevation, squared with the signs kept
+     * so that no square root is needed
+     */
+    const double up = x * m_up.x + y * m_up.y + z * m_up.z;
+
+    return up * fabs(up)
+        > sin_elevation * fabs(sin_elevation) * (x * x + y * y + z * z);
+}
+
+/*
+ * calculate lookangle between the observer and an earth fixed object
+ */
+CoordTopocentric Observer::GetLookAngle(const Ecef &ecef) const
+{
+    /*
+     * the observer is fixed in this frame, so the range rate is the
+     * objects own velocity along the range
+     */
+    const Vector range = ecef.Position() - m_ecef;
+    const Vector range_rate = ecef.Velocity();
+
+    const double range_magnitude = range.Magnitude();
+
+    return MakeLookAngle(range.Dot(m_south),
+            range.Dot(m_east),
+            range.Dot(m_up),
+            range_magnitude,
+            range.Dot(range_rate) / range_magnitude);
+}
 
 /*
  * calculate lookangle between the observer and the passed in Eci object
  */
-CoordTopocentric Observer::GetLookAngle(const Eci &eci)
+CoordTopocentric Observer::GetLookAngle(const Eci &eci) const
 {
     /*
-     * update the observers Eci to match the time of the Eci passed in
-     * if necessary
+     * the observers Eci at the time of the Eci passed in, and the
+     * Local Mean Sidereal Time for observers longitude
      */
-    Update(eci.GetDateTime());
+    return GetLookAngle(eci, Eci(eci.GetDateTime(), m_geo),
+            eci.GetDateTime().ToLocalMeanSiderealTime(m_geo.longitude));
+}
+
+CoordTopocentric Observer::GetLookAngle(
+        const Eci &eci,
+        const TimeContext& context) const
+{
+    return GetLookAngle(eci, Eci(context, m_geo),
+            context.LocalMeanSiderealTime(m_geo.longitude));
+}
+
+void Observer::GetLookAngles(
+        const Eci* eci,
+        const size_t count,
+        CoordTopocentric* topo) const
+{
+    size_t begin = 0;
+
+    while (begin < count)
+    {
+        /*
+         * find the run of objects at the same time
+         */
+        const DateTime dt = eci[begin].GetDateTime();
+        size_t end = begin + 1;
+
+        while (end < count && eci[end].GetDateTime() == dt)
+        {
+            end++;
+        }
+
+        GetLookAngles(TimeContext(dt), eci + begin, end - begin,
+                topo + begin);
+        begin = end;
+    }
+}
+
+void Observer::GetLookAngles(
+        const TimeContext& context,
+        const Eci* eci,
+        const size_t count,
+        CoordTopocentric* topo) const
+{
+    const Eci obs_eci(context, m_geo);
+    const Vector obs_pos = obs_eci.Position();
+    const Vector obs_vel = obs_eci.Velocity();
 
     /*
-     * calculate differences
+     * rotation from eci to south, east, zenith at the observer
      */
-    Vector range_rate = eci.Velocity() - m_eci.Velocity();
-    Vector range = eci.Position() - m_eci.Position();
+    const double theta = context.LocalMeanSiderealTime(m_geo.longitude);
+    const double sin_lat = sin(m_geo.latitude);
+    const double cos_lat = cos(m_geo.latitude);
+    const double sin_theta = sin(theta);
+    const double cos_theta = cos(theta);
+
+    const double sx = sin_lat * cos_theta;
+    const double sy = sin_lat * sin_theta;
+    const double sz = -cos_lat;
+    const double ex = -sin_theta;
+    const double ey = cos_theta;
+    const double zx = cos_lat * cos_theta;
+    const double zy = cos_lat * sin_theta;
+    const double zz = sin_lat;
+
+    double rx[kLookAngleBlock];
+    double ry[kLookAngleBlock];
+    double rz[kLookAngleBlock];
+    double vx[kLookAngleBlock];
+    double vy[kLookAngleBlock];
+    double vz[kLookAngleBlock];
+    double az[kLookAngleBlock];
+    double el[kLookAngleBlock];
+    double range[kLookAngleBlock];
+    double rate[kLookAngleBlock];
+
+    for (size_t begin = 0; begin < count; begin += kLookAngleBlock)
+    {
+        const size_t n = std::min(kLookAngleBlock, count - begin);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const Vector pos = eci[begin + i].Position();
+            const Vector vel = eci[begin + i].Velocity();
+
+            rx[i] = pos.x - obs_pos.x;
+            ry[i] = pos.y - obs_pos.y;
+            rz[i] = pos.z - obs_pos.z;
+            vx[i] = vel.x - obs_vel.x;
+            vy[i] = vel.y - obs_vel.y;
+            vz[i] = vel.z - obs_vel.z;
+        }
 
-    range.w = range.Magnitude();
+        for (size_t i = 0; i < n; i++)
+        {
+            const double top_s = sx * rx[i] + sy * ry[i] + sz * rz[i];
+            const double top_e = ex * rx[i] + ey * ry[i];
+            const double top_z = zx * rx[i] + zy * ry[i] + zz * rz[i];
+            const double r = sqrt(rx[i] * rx[i] + ry[i] * ry[i]
+                    + rz[i] * rz[i]);
 
+            /*
+             * azimuth measured from north, 0 to 2pi
+             */
+            const double a = VectorMath::Atan2(top_e, -top_s);
+
+            az[i] = a < 0.0 ? a + kTWOPI : a;
+            el[i] = VectorMath::Asin(top_z / r);
+            range[i] = r;
+            rate[i] = (rx[i] * vx[i] + ry[i] * vy[i] + rz[i] * vz[i]) / r;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            topo[begin + i] = CoordTopocentric(az[i], el[i], range[i],
+                    rate[i]);
+        }
+    }
+}
+
+/*
+ * calculate lookangle between the observer and the passed in Eci object
+ * given the observers Eci and Local Mean Sidereal Time at the same time
+ */
+CoordTopocentric Observer::GetLookAngle(
+        const Eci &eci,
+        const Eci &obs_eci,
+        const double theta) const
+{
     /*
-     * Calculate Local Mean Sidereal Time for observers longitude
+     * calculate differences
      */
-    double theta = eci.GetDateTime().ToLocalMeanSiderealTime(m_geo.longitude);
+    const Vector range_rate = eci.Velocity() - obs_eci.Velocity();
+    const Vector range = eci.Position() - obs_eci.Position();
+
+    const double range_magnitude = range.Magnitude();
 
     double sin_lat = sin(m_geo.latitude);
     double cos_lat = cos(m_geo.latitude);
@@ -54,6 +268,24 @@ CoordTopocentric Observer::GetLookAngle(const Eci &eci)
         + cos_theta * range.y;
     double top_z = cos_lat * cos_theta * range.x 
         + cos_lat * sin_theta * range.y + sin_lat * range.z;
+
+    return MakeLookAngle(top_s,
+            top_e,
+            top_z,
+            range_magnitude,
+            range.Dot(range_rate) / range_magnitude);
+}
+
+/*
+ * the look angle of a range given in south, east and up components
+ */
+CoordTopocentric Observer::MakeLookAngle(
+        const double top_s,
+        const double top_e,
+        const double top_z,
+        const double range,
+        const double range_rate)
+{
     double az = atan(-top_e / top_s);
 
     if (top_s > 0.0)
@@ -66,8 +298,7 @@ CoordTopocentric Observer::GetLookAngle(const Eci &eci)
         az += 2.0 * kPI;
     }
 
-    double el = asin(top_z / range.w);
-    double rate = range.Dot(range_rate) / range.w;
+    double el = asin(top_z / range);
 
     /*
      * azimuth in radians
@@ -77,6 +308,6 @@ CoordTopocentric Observer::GetLookAngle(const Eci &eci)
      */
     return CoordTopocentric(az,
             el,
-            range.w,
-            rate);
+            range,
+            range_rate);
 }
@@ -19,7 +19,11 @@
 #define OBSERVER_H_
 
 #include "CoordGeodetic.h"
+#include "Ecef.h"
 #include "Eci.h"
+#include "TimeContext.h"
+
+#include <cstddef>
 
 class DateTime;
 class CoordTopocentric;
@@ -39,9 +43,9 @@ public:
     Observer(const double latitude,
             const double longitude,
             const double altitude)
-        : m_geo(latitude, longitude, altitude),
-        m_eci(DateTime(), m_geo)
+        : m_geo(latitude, longitude, altitude)
     {
+        UpdateFrame();
     }
 
     /**
@@ -49,9 +53,9 @@ public:
      * @param[in] geo the observers position
      */
     Observer(const CoordGeodetic &geo)
-        : m_geo(geo),
-        m_eci(DateTime(), geo)
+        : m_geo(geo)
     {
+        UpdateFrame();
     }
 
     /**
@@ -68,7 +72,7 @@ public:
     void SetLocation(const CoordGeodetic& geo)
     {
         m_geo = geo;
-        m_eci.Update(m_eci.GetDateTime(), m_geo);
+        UpdateFrame();
     }
 
     /**
@@ -81,28 +85,123 @@ public:
     }
 
     /**
-     * Get the look angle for the observers position to the object
+     * Get the look angle for the observers position to the object. This
+     * does not modify the observer, so one observer can be shared by many
+     * threads.
      * @param[in] eci the object to find the look angle to
      * @returns the lookup angle
      */
-    CoordTopocentric GetLookAngle(const Eci &eci);
+    CoordTopocentric GetLookAngle(const Eci &eci) const;
+
+    /**
+     * Get the look angle for the observers position to the object, using
+     * the earth orientation already computed for the time of the object
+     * @param[in] eci the object to find the look angle to
+     * @param[in] context the time of eci
+     * @returns the lookup angle
+     */
+    CoordTopocentric GetLookAngle(
+            const Eci &eci,
+            const TimeContext& context) const;
+
+    /**
+     * Get the look angles for the observers position to many objects.
+     * The observers position and orientation are computed once for each
+     * run of objects sharing a time, so passing objects that are all for
+     * the same time (e.g. a catalog propagated with SGP4Batch) is cheapest.
+     * @param[in] eci the objects to find the look angles to
+     * @param[in] count the number of objects
+     * @param[out] topo the look angles, one per object
+     */
+    void GetLookAngles(
+            const Eci* eci,
+            const size_t count,
+            CoordTopocentric* topo) const;
 
-private:
     /**
-     * @param[in] dt the date to update the observers position for
+     * Get the look angles for the observers position to many objects, all
+     * for the time of the given earth orientation. The look angles are
+     * computed column wise in blocks, in loops which the compiler can
+     * vectorise (e.g. -O3 -ffast-math with a vector maths library). The
+     * angles agree with GetLookAngle() to within 1e-10 radians and the
+     * range to within 1e-8 km.
+     * @param[in] context the time of every object
+     * @param[in] eci the objects to find the look angles to
+     * @param[in] count the number of objects
+     * @param[out] topo the look angles, one per object
      */
-    void Update(const DateTime &dt)
+    void GetLookAngles(
+            const TimeContext& context,
+            const Eci* eci,
+            const size_t count,
+            CoordTopocentric* topo) const;
+
+    /**
+     * Test whether the object is above the given elevation, without
+     * computing the look angle. The range vector is compared against the
+     * observers local vertical with one dot product; there is no inverse
+     * trig, square root or allocation, so this suits coarse visibility
+     * scans. Compute the full look angle only where the answer changes.
+     * @param[in] eci the object to test
+     * @param[in] context the time of eci
+     * @param[in] sin_elevation the sine of the minimum elevation, 0 for the
+     * horizon. Precompute it once for a scan.
+     * @returns true if the object is above the minimum elevation
+     */
+    bool IsAboveElevation(
+            const Eci &eci,
+            const TimeContext& context,
+            const double sin_elevation = 0.0) const;
+
+    /**
+     * Test whether the object is above the given elevation, as above, for
+     * an object already in the earth fixed frame
+     * @param[in] ecef the object to test
+     * @param[in] sin_elevation the sine of the minimum elevation
+     * @returns true if the object is above the minimum elevation
+     */
+    bool IsAboveElevation(
+            const Ecef &ecef,
+            const double sin_elevation = 0.0) const
     {
-        if (m_eci != dt)
-        {
-            m_eci.Update(dt, m_geo);
-        }
+        return IsAboveElevation(ecef.Position(), sin_elevation);
     }
 
+    /**
+     * Get the look angle for the observers position to an object in the
+     * earth fixed frame. The observer is a constant vector in that frame,
+     * so this is one fixed rotation into south, east and zenith; rotate
+     * each satellite with Ecef once and evaluate it for every observer.
+     * @param[in] ecef the object to find the look angle to
+     * @returns the lookup angle
+     */
+    CoordTopocentric GetLookAngle(const Ecef &ecef) const;
+
+private:
+    void UpdateFrame();
+    bool IsAboveElevation(
+            const Vector& position,
+            const double sin_elevation) const;
+
+    CoordTopocentric GetLookAngle(
+            const Eci &eci,
+            const Eci &obs_eci,
+            const double theta) const;
+    static CoordTopocentric MakeLookAngle(
+            const double top_s,
+            const double top_e,
+            const double top_z,
+            const double range,
+            const double range_rate);
+
     /** the observers position */
     CoordGeodetic m_geo;
-    /** the observers Eci for a particular time */
-    Eci m_eci;
+    /** the observers position, earth centred earth fixed, in km */
+    Vector m_ecef;
+    /** the observers local south, east and vertical, earth fixed */
+    Vector m_south;
+    Vector m_east;
+    Vector m_up;
 };
 
 #endif
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef OMMEXCEPTION_H_
+#define OMMEXCEPTION_H_
+
+#include <exception>
+#include <string>
+
+/**
+ * @brief The exception that the OmmReader class throws on an error.
+ *
+ * Thrown for a message which is malformed or lacks a mean element. The
+ * reader has moved past the message and continues with the next one.
+ */
+class OmmException : public std::exception
+{
+public:
+    /**
+     * Constructor
+     * @param message Exception message
+     * @param line the line the message starts on
+     */
+    OmmException(const char* message, unsigned int line)
+        : m_message(message),
+        m_line(line)
+    {
+    }
+
+    /**
+     * Destructor
+     */
+    virtual ~OmmException(void) throw ()
+    {
+    }
+
+    /**
+     * Get the exception message
+     * @returns the exception message
+     */
+    virtual const char* what() const throw ()
+    {
+        return m_message.c_str();
+    }
+
+    /**
+     * Get the line the bad message starts on
+     * @returns the line, counting from 1
+     */
+    unsigned int Line() const
+    {
+        return m_line;
+    }
+
+private:
+    /** the exception message */
+    std::string m_message;
+    /** the line the message starts on */
+    unsigned int m_line;
+};
+
+#endif
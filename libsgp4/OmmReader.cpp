@@ -0,0 +1,1153 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "OmmReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    /*
+     * size of the read buffer
+     */
+    const size_t kBufferSize = 64 * 1024;
+
+    enum Field
+    {
+        FIELD_NONE = -1,
+        FIELD_OBJECT_NAME,
+        FIELD_OBJECT_ID,
+        FIELD_NORAD_CAT_ID,
+        FIELD_EPOCH,
+        FIELD_MEAN_MOTION,
+        FIELD_ECCENTRICITY,
+        FIELD_INCLINATION,
+        FIELD_RA_OF_ASC_NODE,
+        FIELD_ARG_OF_PERICENTER,
+        FIELD_MEAN_ANOMALY,
+        FIELD_BSTAR,
+        FIELD_MEAN_MOTION_DOT,
+        FIELD_MEAN_MOTION_DDOT,
+        FIELD_ELEMENT_SET_NO,
+        FIELD_REV_AT_EPOCH,
+        FIELD_MEAN_ELEMENT_THEORY,
+        FIELD_COUNT
+    };
+
+    /*
+     * in the order of Field
+     */
+    const char* const kFieldNames[FIELD_COUNT] =
+    {
+        "OBJECT_NAME",
+        "OBJECT_ID",
+        "NORAD_CAT_ID",
+        "EPOCH",
+        "MEAN_MOTION",
+        "ECCENTRICITY",
+        "INCLINATION",
+        "RA_OF_ASC_NODE",
+        "ARG_OF_PERICENTER",
+        "MEAN_ANOMALY",
+        "BSTAR",
+        "MEAN_MOTION_DOT",
+        "MEAN_MOTION_DDOT",
+        "ELEMENT_SET_NO",
+        "REV_AT_EPOCH",
+        "MEAN_ELEMENT_THEORY"
+    };
+
+    /*
+     * the fields without which there is no element set
+     */
+    const unsigned int kRequiredFields =
+        (1u << FIELD_EPOCH)
+        | (1u << FIELD_MEAN_MOTION)
+        | (1u << FIELD_ECCENTRICITY)
+        | (1u << FIELD_INCLINATION)
+        | (1u << FIELD_RA_OF_ASC_NODE)
+        | (1u << FIELD_ARG_OF_PERICENTER)
+        | (1u << FIELD_MEAN_ANOMALY);
+
+    const double kPowersOfTen[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    int FindField(const std::string& name)
+    {
+        if (name.empty())
+        {
+            return FIELD_NONE;
+        }
+
+        /*
+         * the first letter rules out most names without a full compare
+         */
+        for (int field = 0; field < FIELD_COUNT; field++)
+        {
+            if (name[0] == kFieldNames[field][0] && name == kFieldNames[field])
+            {
+                return field;
+            }
+        }
+        return FIELD_NONE;
+    }
+
+    bool IsDigit(const int c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    bool IsSpace(const int c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    void Trim(std::string& str)
+    {
+        size_t end = str.size();
+        while (end > 0 && IsSpace(str[end - 1]))
+        {
+            end--;
+        }
+        size_t begin = 0;
+        while (begin < end && IsSpace(str[begin]))
+        {
+            begin++;
+        }
+        str.erase(end);
+        str.erase(0, begin);
+    }
+
+    /*
+     * a decimal number, without the locale of strtod. digits past the
+     * nineteenth only scale the result
+     */
+    bool ParseDouble(const std::string& str, double& val)
+    {
+        size_t i = 0;
+        bool negative = false;
+        if (i < str.size() && (str[i] == '+' || str[i] == '-'))
+        {
+            negative = str[i] == '-';
+            i++;
+        }
+
+        unsigned long long mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool any = false;
+
+        for (; i < str.size() && IsDigit(str[i]); i++)
+        {
+            any = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (str[i] - '0');
+                digits += mantissa != 0;
+            }
+            else
+            {
+                exponent++;
+            }
+        }
+        if (i < str.size() && str[i] == '.')
+        {
+            for (i++; i < str.size() && IsDigit(str[i]); i++)
+            {
+                any = true;
+                if (digits < 19)
+                {
+                    mantissa = mantissa * 10 + (str[i] - '0');
+                    digits += mantissa != 0;
+                    exponent--;
+                }
+            }
+        }
+        if (!any)
+        {
+            return false;
+        }
+
+        if (i < str.size() && (str[i] == 'e' || str[i] == 'E'))
+        {
+            i++;
+            bool negative_exponent = false;
+            if (i < str.size() && (str[i] == '+' || str[i] == '-'))
+            {
+                negative_exponent = str[i] == '-';
+                i++;
+            }
+            if (i == str.size())
+            {
+                return false;
+            }
+            int e = 0;
+            for (; i < str.size() && IsDigit(str[i]); i++)
+            {
+                if (e < 10000)
+                {
+                    e = e * 10 + (str[i] - '0');
+                }
+            }
+            exponent += negative_exponent ? -e : e;
+        }
+        if (i != str.size())
+        {
+            return false;
+        }
+
+        /*
+         * exact for up to 15 digits and 22 powers, as the tle parser
+         */
+        double result = static_cast<double>(mantissa);
+        if (exponent < 0 && exponent >= -22)
+        {
+            result /= kPowersOfTen[-exponent];
+        }
+        else if (exponent > 0 && exponent <= 22)
+        {
+            result *= kPowersOfTen[exponent];
+        }
+        else if (exponent != 0 && mantissa != 0)
+        {
+            result *= pow(10.0, exponent);
+        }
+
+        val = negative ? -result : result;
+        return true;
+    }
+
+    bool ParseUnsigned(const std::string& str, unsigned int& val)
+    {
+        if (str.empty())
+        {
+            return false;
+        }
+
+        unsigned long long result = 0;
+        for (size_t i = 0; i < str.size(); i++)
+        {
+            if (!IsDigit(str[i]))
+            {
+                return false;
+            }
+            result = result * 10 + (str[i] - '0');
+            if (result > 0xffffffffULL)
+            {
+                return false;
+            }
+        }
+
+        val = static_cast<unsigned int>(result);
+        return true;
+    }
+
+    bool ParseDigits(
+            const std::string& str,
+            size_t& i,
+            const size_t count,
+            int& val)
+    {
+        val = 0;
+        for (size_t end = i + count; i < end; i++)
+        {
+            if (i >= str.size() || !IsDigit(str[i]))
+            {
+                return false;
+            }
+            val = val * 10 + (str[i] - '0');
+        }
+        return true;
+    }
+
+    /*
+     * YYYY-MM-DDThh:mm:ss[.f][Z] or YYYY-DDDThh:mm:ss[.f][Z], in UTC
+     */
+    bool ParseEpoch(const std::string& str, DateTime& val)
+    {
+        size_t i = 0;
+        int year;
+        int month = 0;
+        int day;
+        if (!ParseDigits(str, i, 4, year)
+                || !DateTime::IsValidYear(year)
+                || i >= str.size() || str[i++] != '-')
+        {
+            return false;
+        }
+
+        size_t width = 0;
+        while (i + width < str.size() && IsDigit(str[i + width]))
+        {
+            width++;
+        }
+        if (width == 3)
+        {
+            ParseDigits(str, i, 3, day);
+            if (day < 1 || day > (DateTime::IsLeapYear(year) ? 366 : 365))
+            {
+                return false;
+            }
+        }
+        else if (width == 2)
+        {
+            ParseDigits(str, i, 2, month);
+            if (i >= str.size() || str[i++] != '-'
+                    || !ParseDigits(str, i, 2, day)
+                    || !DateTime::IsValidYearMonthDay(year, month, day))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        int hour;
+        int minute;
+        int second;
+        if (i >= str.size() || (str[i] != 'T' && str[i] != ' '))
+        {
+            return false;
+        }
+        i++;
+        if (!ParseDigits(str, i, 2, hour)
+                || i >= str.size() || str[i++] != ':'
+                || !ParseDigits(str, i, 2, minute)
+                || i >= str.size() || str[i++] != ':'
+                || !ParseDigits(str, i, 2, second)
+                || hour > 23 || minute > 59 || second > 60)
+        {
+            return false;
+        }
+
+        /*
+         * the fraction, rounded to the microsecond ticks
+         */
+        long long ticks = 0;
+        if (i < str.size() && str[i] == '.')
+        {
+            long long scale = TicksPerSecond;
+            bool round_up = false;
+            for (i++; i < str.size() && IsDigit(str[i]); i++)
+            {
+                if (scale > 1)
+                {
+                    scale /= 10;
+                    ticks += scale * (str[i] - '0');
+                }
+                else if (scale == 1)
+                {
+                    round_up = str[i] >= '5';
+                    scale = 0;
+                }
+            }
+            ticks += round_up;
+        }
+        if (i < str.size() && str[i] == 'Z')
+        {
+            i++;
+        }
+        if (i != str.size())
+        {
+            return false;
+        }
+
+        ticks += hour * TicksPerHour
+            + minute * TicksPerMinute
+            + second * TicksPerSecond;
+        if (month == 0)
+        {
+            val = DateTime(year, 1, 1).AddTicks((day - 1) * TicksPerDay + ticks);
+        }
+        else
+        {
+            val = DateTime(year, month, day).AddTicks(ticks);
+        }
+        return true;
+    }
+
+    void AppendUtf8(std::string& str, unsigned long code)
+    {
+        if (code < 0x80)
+        {
+            str += static_cast<char>(code);
+        }
+        else if (code < 0x800)
+        {
+            str += static_cast<char>(0xc0 | (code >> 6));
+            str += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else if (code < 0x10000)
+        {
+            str += static_cast<char>(0xe0 | (code >> 12));
+            str += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            str += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else
+        {
+            str += static_cast<char>(0xf0 | ((code >> 18) & 0x07));
+            str += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            str += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            str += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+
+    /*
+     * replace the xml entity references in text. unknown ones are kept
+     */
+    void DecodeEntities(const std::string& text, std::string& decoded)
+    {
+        if (text.find('&') == std::string::npos)
+        {
+            decoded = text;
+            return;
+        }
+
+        decoded.clear();
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            const size_t end = text[i] == '&' ? text.find(';', i) : std::string::npos;
+            if (end == std::string::npos)
+            {
+                decoded += text[i];
+                continue;
+            }
+
+            const std::string entity(text, i + 1, end - i - 1);
+            if (entity == "amp")
+            {
+                decoded += '&';
+            }
+            else if (entity == "lt")
+            {
+                decoded += '<';
+            }
+            else if (entity == "gt")
+            {
+                decoded += '>';
+            }
+            else if (entity == "quot")
+            {
+                decoded += '"';
+            }
+            else if (entity == "apos")
+            {
+                decoded += '\'';
+            }
+            else if (entity.size() > 1 && entity[0] == '#')
+            {
+                const bool hex = entity[1] == 'x' || entity[1] == 'X';
+                unsigned long code = 0;
+                for (size_t j = hex ? 2 : 1; j < entity.size() && code < 0x110000; j++)
+                {
+                    const char c = entity[j];
+                    if (IsDigit(c))
+                    {
+                        code = code * (hex ? 16 : 10) + (c - '0');
+                    }
+                    else if (hex && c >= 'a' && c <= 'f')
+                    {
+                        code = code * 16 + (c - 'a' + 10);
+                    }
+                    else if (hex && c >= 'A' && c <= 'F')
+                    {
+                        code = code * 16 + (c - 'A' + 10);
+                    }
+                    else
+                    {
+                        code = 0x110000;
+                    }
+                }
+                if (code >= 0x110000)
+                {
+                    decoded.append(text, i, end - i + 1);
+                }
+                else
+                {
+                    AppendUtf8(decoded, code);
+                }
+            }
+            else
+            {
+                decoded.append(text, i, end - i + 1);
+            }
+            i = end;
+        }
+    }
+}
+
+OmmReader::OmmReader(std::istream& stream, Format format)
+    : stream_(stream),
+    format_(format),
+    buffer_(kBufferSize),
+    position_(0),
+    end_(0),
+    line_(1),
+    record_line_(0),
+    seen_(0),
+    pending_(false),
+    pending_line_(0),
+    field_(FIELD_NONE)
+{
+}
+
+bool OmmReader::Next(Omm& omm)
+{
+    if (format_ == FORMAT_AUTO)
+    {
+        Detect();
+    }
+
+    switch (format_)
+    {
+    case FORMAT_CSV:
+        return NextCsv(omm);
+    case FORMAT_KVN:
+        return NextKvn(omm);
+    case FORMAT_XML:
+        return NextXml(omm);
+    default:
+        return false;
+    }
+}
+
+bool OmmReader::Fill()
+{
+    if (!stream_)
+    {
+        return false;
+    }
+
+    stream_.read(&buffer_[0], buffer_.size());
+    position_ = 0;
+    end_ = static_cast<size_t>(stream_.gcount());
+    return end_ > 0;
+}
+
+int OmmReader::Get()
+{
+    if (position_ == end_ && !Fill())
+    {
+        return -1;
+    }
+
+    const char c = buffer_[position_++];
+    if (c == '\n')
+    {
+        line_++;
+    }
+    return static_cast<unsigned char>(c);
+}
+
+int OmmReader::Peek()
+{
+    if (position_ == end_ && !Fill())
+    {
+        return -1;
+    }
+
+    return static_cast<unsigned char>(buffer_[position_]);
+}
+
+/*
+ * read a line without its line ending. false at the end of the stream
+ */
+bool OmmReader::ReadLine(std::string& line)
+{
+    line.clear();
+
+    bool any = false;
+    while (position_ < end_ || Fill())
+    {
+        any = true;
+
+        const char* begin = &buffer_[position_];
+        const char* newline = static_cast<const char*>(
+                memchr(begin, '\n', end_ - position_));
+        if (newline == NULL)
+        {
+            line.append(begin, end_ - position_);
+            position_ = end_;
+            continue;
+        }
+
+        line.append(begin, newline);
+        position_ += newline - begin + 1;
+        line_++;
+        break;
+    }
+
+    if (!line.empty() && line[line.size() - 1] == '\r')
+    {
+        line.erase(line.size() - 1);
+    }
+    return any;
+}
+
+/*
+ * xml starts with markup and kvn with a KEY = value line, anything else
+ * is taken for the header row of csv
+ */
+void OmmReader::Detect()
+{
+    int c = Peek();
+    if (c == 0xef)
+    {
+        /*
+         * utf-8 byte order mark
+         */
+        Get();
+        Get();
+        Get();
+        c = Peek();
+    }
+    while (IsSpace(c))
+    {
+        Get();
+        c = Peek();
+    }
+
+    if (c == '<')
+    {
+        format_ = FORMAT_XML;
+    }
+    else if (c >= 0)
+    {
+        const char* begin = &buffer_[position_];
+        const size_t size = end_ - position_;
+        const char* newline = static_cast<const char*>(
+                memchr(begin, '\n', size));
+        const size_t length = newline == NULL ? size : newline - begin;
+        format_ = memchr(begin, '=', length) != NULL
+            ? FORMAT_KVN
+            : FORMAT_CSV;
+    }
+}
+
+bool OmmReader::NextCsv(Omm& omm)
+{
+    for (;;)
+    {
+        const unsigned int line = line_;
+        if (!ReadLine(text_))
+        {
+            return false;
+        }
+        if (text_.find_first_not_of(" \t") == std::string::npos)
+        {
+            continue;
+        }
+
+        const size_t count = SplitCsv(text_);
+
+        /*
+         * a header row, which is repeated where files were joined
+         */
+        if (columns_.empty() || cells_[0] == header_)
+        {
+            header_ = cells_[0];
+            columns_.resize(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                for (size_t j = 0; j < cells_[i].size(); j++)
+                {
+                    if (cells_[i][j] >= 'a' && cells_[i][j] <= 'z')
+                    {
+                        cells_[i][j] = cells_[i][j] - 'a' + 'A';
+                    }
+                }
+                columns_[i] = FindField(cells_[i]);
+            }
+            continue;
+        }
+
+        Begin(omm, line);
+        for (size_t i = 0; i < count && i < columns_.size(); i++)
+        {
+            SetField(omm, columns_[i], cells_[i]);
+        }
+        Finish();
+        return true;
+    }
+}
+
+/*
+ * split a row into cells_, unquoting quoted cells. returns the number of
+ * cells, which may be less than the size of cells_
+ */
+size_t OmmReader::SplitCsv(const std::string& line)
+{
+    size_t count = 0;
+    size_t i = 0;
+    for (;;)
+    {
+        if (count == cells_.size())
+        {
+            cells_.push_back(std::string());
+        }
+        std::string& cell = cells_[count++];
+        cell.clear();
+
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t'))
+        {
+            i++;
+        }
+
+        if (i < line.size() && line[i] == '"')
+        {
+            for (i++; i < line.size(); i++)
+            {
+                if (line[i] != '"')
+                {
+                    cell += line[i];
+                }
+                else if (i + 1 < line.size() && line[i + 1] == '"')
+                {
+                    cell += '"';
+                    i++;
+                }
+                else
+                {
+                    i++;
+                    break;
+                }
+            }
+            i = std::min(line.find(',', i), line.size());
+        }
+        else
+        {
+            const size_t comma = std::min(line.find(',', i), line.size());
+            cell.assign(line, i, comma - i);
+            Trim(cell);
+            i = comma;
+        }
+
+        if (i >= line.size())
+        {
+            return count;
+        }
+        i++;
+    }
+}
+
+bool OmmReader::NextKvn(Omm& omm)
+{
+    bool started = pending_;
+    if (pending_)
+    {
+        Begin(omm, pending_line_);
+        pending_ = false;
+    }
+
+    for (;;)
+    {
+        const unsigned int line = line_;
+        if (!ReadLine(text_))
+        {
+            if (started)
+            {
+                Finish();
+            }
+            return started;
+        }
+
+        const size_t equals = text_.find('=');
+        if (equals == std::string::npos)
+        {
+            /*
+             * blank and COMMENT lines
+             */
+            continue;
+        }
+
+        name_.assign(text_, 0, equals);
+        Trim(name_);
+        value_.assign(text_, equals + 1, std::string::npos);
+
+        /*
+         * drop the units, as in 15.5 [rev/day]
+         */
+        if (!value_.empty() && value_[value_.size() - 1] == ']')
+        {
+            const size_t bracket = value_.rfind('[');
+            if (bracket != std::string::npos)
+            {
+                value_.erase(bracket);
+            }
+        }
+        Trim(value_);
+
+        if (name_ == "CCSDS_OMM_VERS")
+        {
+            if (started)
+            {
+                pending_ = true;
+                pending_line_ = line;
+                Finish();
+                return true;
+            }
+            Begin(omm, line);
+            started = true;
+            continue;
+        }
+
+        if (!started)
+        {
+            /*
+             * a message without its header line
+             */
+            Begin(omm, line);
+            started = true;
+        }
+        SetField(omm, FindField(name_), value_);
+    }
+}
+
+bool OmmReader::NextXml(Omm& omm)
+{
+    bool started = false;
+
+    for (;;)
+    {
+        if (position_ == end_ && !Fill())
+        {
+            if (started)
+            {
+                error_ = "Unterminated omm element";
+                Finish();
+            }
+            return false;
+        }
+
+        /*
+         * the text up to the next markup, kept only inside a field
+         */
+        const char* begin = &buffer_[position_];
+        const char* open = static_cast<const char*>(
+                memchr(begin, '<', end_ - position_));
+        const char* text_end = open == NULL ? &buffer_[0] + end_ : open;
+        if (field_ != FIELD_NONE)
+        {
+            text_.append(begin, text_end);
+        }
+        line_ += static_cast<unsigned int>(std::count(begin, text_end, '\n'));
+        position_ += text_end - begin;
+        if (open == NULL)
+        {
+            continue;
+        }
+        position_++;
+
+        const unsigned int line = line_;
+        switch (ReadMarkup(name_))
+        {
+        case MARKUP_START:
+            if (name_ == "omm")
+            {
+                Begin(omm, line);
+                started = true;
+                field_ = FIELD_NONE;
+            }
+            else if (started)
+            {
+                field_ = FindField(name_);
+                text_.clear();
+            }
+            break;
+        case MARKUP_END:
+            if (!started)
+            {
+                break;
+            }
+            if (name_ == "omm")
+            {
+                field_ = FIELD_NONE;
+                Finish();
+                return true;
+            }
+            if (field_ != FIELD_NONE && name_ == kFieldNames[field_])
+            {
+                DecodeEntities(text_, value_);
+                Trim(value_);
+                SetField(omm, field_, value_);
+            }
+            field_ = FIELD_NONE;
+            break;
+        case MARKUP_EOF:
+            if (started)
+            {
+                error_ = "Unterminated omm element";
+                Finish();
+            }
+            return false;
+        default:
+            break;
+        }
+    }
+}
+
+/*
+ * read the markup after a '<'. name is the local name of an element, any
+ * namespace prefix removed. the text of a CDATA section goes to text_
+ */
+OmmReader::Markup OmmReader::ReadMarkup(std::string& name)
+{
+    name.clear();
+
+    int c = Peek();
+    if (c == '!')
+    {
+        Get();
+        if (Peek() == '-')
+        {
+            return SkipPast("-->", NULL) ? MARKUP_OTHER : MARKUP_EOF;
+        }
+        if (Peek() == '[')
+        {
+            /*
+             * [CDATA[ ... ]]>
+             */
+            if (!SkipPast("[CDATA[", NULL))
+            {
+                return MARKUP_EOF;
+            }
+            return SkipPast("]]>", field_ != FIELD_NONE ? &text_ : NULL)
+                ? MARKUP_OTHER
+                : MARKUP_EOF;
+        }
+        return SkipPast(">", NULL) ? MARKUP_OTHER : MARKUP_EOF;
+    }
+    if (c == '?')
+    {
+        Get();
+        return SkipPast("?>", NULL) ? MARKUP_OTHER : MARKUP_EOF;
+    }
+
+    const bool end = c == '/';
+    if (end)
+    {
+        Get();
+    }
+
+    /*
+     * the name, in one piece where the buffer holds it whole
+     */
+    for (;;)
+    {
+        if (position_ == end_ && !Fill())
+        {
+            return MARKUP_EOF;
+        }
+
+        size_t i = position_;
+        while (i < end_ && !IsSpace(buffer_[i])
+                && buffer_[i] != '/' && buffer_[i] != '>')
+        {
+            i++;
+        }
+        name.append(&buffer_[position_], i - position_);
+        position_ = i;
+        if (i < end_)
+        {
+            break;
+        }
+    }
+
+    const size_t colon = name.rfind(':');
+    if (colon != std::string::npos)
+    {
+        name.erase(0, colon + 1);
+    }
+    c = Get();
+
+    /*
+     * the attributes, which may quote a '>'
+     */
+    bool empty = false;
+    char quote = 0;
+    while (c >= 0 && (c != '>' || quote != 0))
+    {
+        if (quote != 0)
+        {
+            quote = c == quote ? 0 : quote;
+        }
+        else if (c == '"' || c == '\'')
+        {
+            quote = static_cast<char>(c);
+        }
+        empty = c == '/';
+        c = Get();
+    }
+
+    if (c < 0)
+    {
+        return MARKUP_EOF;
+    }
+    if (end)
+    {
+        return MARKUP_END;
+    }
+    return empty ? MARKUP_EMPTY : MARKUP_START;
+}
+
+/*
+ * read up to and including terminator, appending what comes before it
+ * to content if given. false at the end of the stream
+ */
+bool OmmReader::SkipPast(const char* terminator, std::string* content)
+{
+    const size_t length = strlen(terminator);
+    std::string window;
+
+    for (;;)
+    {
+        const int c = Get();
+        if (c < 0)
+        {
+            return false;
+        }
+
+        window += static_cast<char>(c);
+        if (window.size() > length)
+        {
+            window.erase(0, 1);
+        }
+        if (window == terminator)
+        {
+            if (content != NULL)
+            {
+                content->erase(content->size() - (length - 1));
+            }
+            return true;
+        }
+
+        if (content != NULL)
+        {
+            *content += static_cast<char>(c);
+        }
+    }
+}
+
+void OmmReader::Begin(Omm& omm, unsigned int line)
+{
+    omm = Omm();
+    record_line_ = line;
+    seen_ = 0;
+    error_.clear();
+}
+
+void OmmReader::SetField(Omm& omm, int field, const std::string& value)
+{
+    if (field == FIELD_NONE || value.empty())
+    {
+        return;
+    }
+
+    bool valid = true;
+    switch (field)
+    {
+    case FIELD_OBJECT_NAME:
+        omm.name_ = value;
+        break;
+    case FIELD_OBJECT_ID:
+        omm.object_id_ = value;
+        break;
+    case FIELD_NORAD_CAT_ID:
+        valid = ParseUnsigned(value, omm.norad_number_);
+        break;
+    case FIELD_EPOCH:
+        valid = ParseEpoch(value, omm.epoch_);
+        break;
+    case FIELD_MEAN_MOTION:
+        valid = ParseDouble(value, omm.mean_motion_);
+        break;
+    case FIELD_ECCENTRICITY:
+        valid = ParseDouble(value, omm.eccentricity_);
+        break;
+    case FIELD_INCLINATION:
+        valid = ParseDouble(value, omm.inclination_);
+        break;
+    case FIELD_RA_OF_ASC_NODE:
+        valid = ParseDouble(value, omm.right_ascending_node_);
+        break;
+    case FIELD_ARG_OF_PERICENTER:
+        valid = ParseDouble(value, omm.argument_perigee_);
+        break;
+    case FIELD_MEAN_ANOMALY:
+        valid = ParseDouble(value, omm.mean_anomaly_);
+        break;
+    case FIELD_BSTAR:
+        valid = ParseDouble(value, omm.bstar_);
+        break;
+    case FIELD_MEAN_MOTION_DOT:
+        valid = ParseDouble(value, omm.mean_motion_dt2_);
+        break;
+    case FIELD_MEAN_MOTION_DDOT:
+        valid = ParseDouble(value, omm.mean_motion_ddt6_);
+        break;
+    case FIELD_ELEMENT_SET_NO:
+        valid = ParseUnsigned(value, omm.element_number_);
+        break;
+    case FIELD_REV_AT_EPOCH:
+        valid = ParseUnsigned(value, omm.orbit_number_);
+        break;
+    case FIELD_MEAN_ELEMENT_THEORY:
+        /*
+         * SGP4-XP and others have elements of their own meaning
+         */
+        if (value != "SGP4" && value != "SGP/SGP4" && error_.empty())
+        {
+            error_ = "Mean elements are not for SGP4: " + value;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (!valid && error_.empty())
+    {
+        error_ = std::string("Invalid ") + kFieldNames[field] + ": " + value;
+    }
+    seen_ |= 1u << field;
+}
+
+void OmmReader::Finish()
+{
+    if (error_.empty() && (seen_ & kRequiredFields) != kRequiredFields)
+    {
+        for (int field = 0; field < FIELD_COUNT; field++)
+        {
+            if ((kRequiredFields & ~seen_ & (1u << field)) != 0)
+            {
+                error_ = std::string("Missing ") + kFieldNames[field];
+                break;
+            }
+        }
+    }
+
+    if (!error_.empty())
+    {
+        throw OmmException(error_.c_str(), record_line_);
+    }
+}
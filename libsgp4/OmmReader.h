@@ -0,0 +1,168 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef OMMREADER_H_
+#define OMMREADER_H_
+
+#include "Omm.h"
+#include "OmmException.h"
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads orbit mean-elements messages from a stream, one at a time.
+ *
+ * Takes the CSV, KVN and XML forms of CCSDS OMM, as published by
+ * CelesTrak and Space-Track. The stream is read through a fixed buffer and
+ * each message is decoded as it passes, without a document tree or tle
+ * text, so a file of any size is read in constant memory. Fields the
+ * reader does not use are skipped, as are units and comments.
+ *
+ * A message which is malformed, lacks a mean element or carries elements
+ * of another theory than SGP4 is thrown as an OmmException once it has
+ * been read past, so the caller can catch it and carry on.
+ */
+class OmmReader
+{
+public:
+    /**
+     * @brief The form of the messages.
+     */
+    enum Format
+    {
+        /*
+         * decided from the start of the stream
+         */
+        FORMAT_AUTO,
+        /*
+         * a header row of field names, then one message per row
+         */
+        FORMAT_CSV,
+        /*
+         * KEY = value lines, each message starting with CCSDS_OMM_VERS
+         */
+        FORMAT_KVN,
+        /*
+         * omm elements, on their own or inside an ndm element
+         */
+        FORMAT_XML
+    };
+
+    /**
+     * @param[in] stream the stream to read, which must outlive the reader
+     * @param[in] format the form of the messages
+     */
+    explicit OmmReader(std::istream& stream, Format format = FORMAT_AUTO);
+
+    virtual ~OmmReader()
+    {
+    }
+
+    /**
+     * Read the next message
+     * @param[out] omm the element set of the message
+     * @returns false at the end of the stream
+     * @throws OmmException for a bad message, after which the reader
+     * continues with the next one
+     */
+    bool Next(Omm& omm);
+
+    /**
+     * @returns the form of the messages, FORMAT_AUTO until the first
+     * Next() has decided it
+     */
+    Format GetFormat() const
+    {
+        return format_;
+    }
+
+private:
+    enum Markup
+    {
+        MARKUP_START,
+        MARKUP_END,
+        MARKUP_EMPTY,
+        MARKUP_OTHER,
+        MARKUP_EOF
+    };
+
+    OmmReader(const OmmReader&);
+    OmmReader& operator=(const OmmReader&);
+
+    bool Fill();
+    int Get();
+    int Peek();
+    bool ReadLine(std::string& line);
+    void Detect();
+
+    bool NextCsv(Omm& omm);
+    bool NextKvn(Omm& omm);
+    bool NextXml(Omm& omm);
+    size_t SplitCsv(const std::string& line);
+    Markup ReadMarkup(std::string& name);
+    bool SkipPast(const char* terminator, std::string* content);
+
+    void Begin(Omm& omm, unsigned int line);
+    void SetField(Omm& omm, int field, const std::string& value);
+    void Finish();
+
+    std::istream& stream_;
+    Format format_;
+
+    std::vector<char> buffer_;
+    size_t position_;
+    size_t end_;
+    /*
+     * the line being read, counting from 1
+     */
+    unsigned int line_;
+
+    /*
+     * the message being read
+     */
+    unsigned int record_line_;
+    unsigned int seen_;
+    std::string error_;
+
+    /*
+     * KVN: the CCSDS_OMM_VERS line of the next message has been read
+     */
+    bool pending_;
+    unsigned int pending_line_;
+    /*
+     * CSV: the field of each column, and the first column of the header
+     */
+    std::vector<int> columns_;
+    std::string header_;
+    std::vector<std::string> cells_;
+    /*
+     * XML: the field whose text is being collected
+     */
+    int field_;
+
+    /*
+     * reused for each line, name and value
+     */
+    std::string text_;
+    std::string name_;
+    std::string value_;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ONCEFLAG_H_
+#define ONCEFLAG_H_
+
+#include "Threading.h"
+
+/**
+ * @brief Runs an initialisation exactly once, however many threads ask.
+ *
+ * Once done, checking costs a single load. If the initialisation throws
+ * it is not marked done, and the next caller tries again. A copy takes
+ * the state of the original, but has its own lock. The lock and the
+ * load come from Threading.h, so this builds with C++11, Win32 or POSIX
+ * threads; with SGP4_NO_THREADS it is for single threaded use only.
+ */
+class OnceFlag
+{
+public:
+    /**
+     * @param[in] done whether the initialisation has already been run
+     */
+    explicit OnceFlag(bool done = false)
+        : done_(done)
+    {
+    }
+
+    OnceFlag(const OnceFlag& other)
+        : done_(other.Done())
+    {
+    }
+
+    OnceFlag& operator=(const OnceFlag& other)
+    {
+        SetDone(other.Done());
+        return *this;
+    }
+
+    /**
+     * @returns whether the initialisation has been run
+     */
+    bool Done() const
+    {
+        return done_.Load();
+    }
+
+    /**
+     * Mark the initialisation as run or not, without running it. Not
+     * safe against concurrent Call()
+     * @param[in] done the new state
+     */
+    void SetDone(bool done)
+    {
+        done_.Store(done);
+    }
+
+    /**
+     * Run (object.*init)() unless it has been run. Other threads calling
+     * at the same time wait for it to finish. init is const, so what it
+     * computes must be held in mutable members
+     * @param[in] object the object to initialise
+     * @param[in] init the initialisation
+     */
+    template <class T>
+    void Call(const T& object, void (T::*init)() const)
+    {
+        if (Done())
+        {
+            return;
+        }
+
+        Threading::ScopedLock lock(mutex_);
+        if (!Done())
+        {
+            (object.*init)();
+            SetDone(true);
+        }
+    }
+
+private:
+    Threading::AtomicBool done_;
+    Threading::Mutex mutex_;
+};
+
+#endif
@@ -22,6 +22,7 @@
 #include "DateTime.h"
 
 class Tle;
+class Omm;
 
 /**
  * @brief The extracted orbital elements used by the SGP4 propagator.
@@ -30,6 +31,7 @@ class OrbitalElements
 {
 public:
     OrbitalElements(const Tle& tle);
+    OrbitalElements(const Omm& omm);
 
     virtual ~OrbitalElements()
     {
@@ -132,6 +134,17 @@ public:
     }
 
 private:
+    friend class Catalog;
+
+    /*
+     * for Catalog, which fills in every field from an image
+     */
+    OrbitalElements()
+    {
+    }
+
+    void RecoverMeanMotion();
+
     double mean_anomoly_;
     double ascending_node_;
     double argument_perigee_;
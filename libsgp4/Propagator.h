@@ -0,0 +1,60 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PROPAGATOR_H_
+#define PROPAGATOR_H_
+
+#include "DateTime.h"
+#include "Eci.h"
+#include "SGP4Kernel.h"
+#include "TimeGrid.h"
+
+#include <vector>
+
+/**
+ * @brief Anything that gives the position of a satellite at a time.
+ *
+ * Implemented by SGP4 and ChebyshevEphemeris, so that code searching or
+ * drawing an orbit can be given either.
+ */
+class Propagator
+{
+public:
+    virtual ~Propagator()
+    {
+    }
+
+    /**
+     * @param[in] date the time to find the position for
+     * @returns the position
+     */
+    virtual Eci FindPosition(const DateTime& date) const = 0;
+
+    /**
+     * @param[in] grid the times to find the positions for
+     * @param[out] positions the positions, one per time
+     * @param[in] precision the precision tier, where the propagator has
+     * a choice
+     */
+    virtual void FindPositions(
+            const TimeGrid& grid,
+            std::vector<Eci>& positions,
+            const SGP4Kernel::Precision precision
+                = SGP4Kernel::PRECISION_EXACT) const = 0;
+};
+
+#endif
@@ -21,50 +21,135 @@
 #include "Vector.h"
 #include "SatelliteException.h"
 #include "DecayedException.h"
+#include "Threading.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 
+const SGP4Kernel::NearSpaceLane SGP4::Empty_NearSpaceLane = SGP4Kernel::NearSpaceLane();
 const SGP4::CommonConstants SGP4::Empty_CommonConstants = SGP4::CommonConstants();
 const SGP4::NearSpaceConstants SGP4::Empty_NearSpaceConstants = SGP4::NearSpaceConstants();
 const SGP4::DeepSpaceConstants SGP4::Empty_DeepSpaceConstants = SGP4::DeepSpaceConstants();
 const SGP4::IntegratorConstants SGP4::Empty_IntegratorConstants = SGP4::IntegratorConstants();
 const SGP4::IntegratorParams SGP4::Empty_IntegratorParams = SGP4::IntegratorParams();
+const SGP4::KeplerState SGP4::Empty_KeplerState = SGP4::KeplerState();
 
-void SGP4::SetTle(const Tle& tle)
+/*
+ * deep space resonance integrator step (minutes) and half its square
+ */
+static const double kIntegratorStep = 720.0;
+static const double kIntegratorStep2 = 259200.0;
+/*
+ * number of integrator checkpoints kept either side of epoch (15 days)
+ */
+static const int kIntegratorCheckpoints = 30;
+/*
+ * largest change in capu (radians) for which the last kepler solution is
+ * used as the starting guess
+ */
+static const double kMaxKeplerWarmStep = 0.5;
+
+void SGP4::SetTle(const Tle& tle, const Initialisation init)
 {
     /*
      * extract and format tle data
      */
     elements_ = OrbitalElements(tle);
 
-    Initialise();
+    initialised_.SetDone(false);
+    if (init == INITIALISE_NOW)
+    {
+        Initialise();
+        initialised_.SetDone(true);
+
+        if (elements_status_ != SGP4Kernel::STATUS_OK)
+        {
+            ThrowStatus(elements_status_, 0.0, NULL, NULL);
+        }
+    }
+}
+
+namespace
+{
+    /*
+     * the satellites WarmUp() shares between its threads
+     */
+    struct WarmUpQueue
+    {
+        const std::vector<SGP4*>* satellites;
+        Threading::AtomicCounter next;
+    };
+
+    void* WarmUpThread(void* arg)
+    {
+        WarmUpQueue* queue = static_cast<WarmUpQueue*>(arg);
+        const std::vector<SGP4*>& satellites = *queue->satellites;
+
+        for (size_t i = queue->next.Next();
+                i < satellites.size();
+                i = queue->next.Next())
+        {
+            satellites[i]->EnsureInitialised();
+        }
+
+        return NULL;
+    }
+}
+
+void SGP4::WarmUp(
+        const std::vector<SGP4*>& satellites,
+        const unsigned int threads)
+{
+    size_t count = threads;
+    if (count == 0)
+    {
+        count = Threading::ProcessorCount();
+    }
+    count = std::min(count, satellites.size());
+
+    WarmUpQueue queue;
+    queue.satellites = &satellites;
+
+    /*
+     * this thread is one of the workers. if a thread cannot be started,
+     * or there are none, the others take its share
+     */
+    Threading::RunWorkers(&WarmUpThread, &queue, count);
 }
 
-void SGP4::Initialise()
+void SGP4::Initialise() const
 {
     /*
      * reset all constants etc
      */
     Reset();
 
+    /*
+     * only used here, the propagators read the lane built from them
+     */
+    CommonConstants common = Empty_CommonConstants;
+    NearSpaceConstants nearspace = Empty_NearSpaceConstants;
+
     /*
      * error checks
      */
     if (elements_.Eccentricity() < 0.0 || elements_.Eccentricity() > 0.999)
     {
-        throw SatelliteException("Eccentricity out of range");
+        elements_status_ = SGP4Kernel::STATUS_ECCENTRICITY_RANGE;
+        return;
     }
 
     if (elements_.Inclination() < 0.0 || elements_.Inclination() > kPI)
     {
-        throw SatelliteException("Inclination out of range");
+        elements_status_ = SGP4Kernel::STATUS_INCLINATION_RANGE;
+        return;
     }
 
-    common_consts_.cosio = cos(elements_.Inclination());
-    common_consts_.sinio = sin(elements_.Inclination());
-    const double theta2 = common_consts_.cosio * common_consts_.cosio;
-    common_consts_.x3thm1 = 3.0 * theta2 - 1.0;
+    common.cosio = cos(elements_.Inclination());
+    common.sinio = sin(elements_.Inclination());
+    const double theta2 = common.cosio * common.cosio;
+    common.x3thm1 = 3.0 * theta2 - 1.0;
     const double eosq = elements_.Eccentricity() * elements_.Eccentricity();
     const double betao2 = 1.0 - eosq;
     const double betao = sqrt(betao2);
@@ -114,104 +199,134 @@ void SGP4::Initialise()
                 * elements_.RecoveredSemiMajorAxis()
                 * betao2 * betao2);
     const double tsi = 1.0 / (elements_.RecoveredSemiMajorAxis() - s4);
-    common_consts_.eta = elements_.RecoveredSemiMajorAxis()
+    common.eta = elements_.RecoveredSemiMajorAxis()
         * elements_.Eccentricity() * tsi;
-    const double etasq = common_consts_.eta * common_consts_.eta;
-    const double eeta = elements_.Eccentricity() * common_consts_.eta;
+    const double etasq = common.eta * common.eta;
+    const double eeta = elements_.Eccentricity() * common.eta;
     const double psisq = fabs(1.0 - etasq);
     const double coef = qoms24 * pow(tsi, 4.0);
     const double coef1 = coef / pow(psisq, 3.5);
     const double c2 = coef1 * elements_.RecoveredMeanMotion()
         * (elements_.RecoveredSemiMajorAxis()
         * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq))
-        + 0.75 * kCK2 * tsi / psisq * common_consts_.x3thm1
+        + 0.75 * kCK2 * tsi / psisq * common.x3thm1
         * (8.0 + 3.0 * etasq * (8.0 + etasq)));
-    common_consts_.c1 = elements_.BStar() * c2;
-    common_consts_.a3ovk2 = -kXJ3 / kCK2 * kAE * kAE * kAE;
-    common_consts_.x1mth2 = 1.0 - theta2;
-    common_consts_.c4 = 2.0 * elements_.RecoveredMeanMotion()
+    common.c1 = elements_.BStar() * c2;
+    common.a3ovk2 = -kXJ3 / kCK2 * kAE * kAE * kAE;
+    common.x1mth2 = 1.0 - theta2;
+    common.c4 = 2.0 * elements_.RecoveredMeanMotion()
         * coef1 * elements_.RecoveredSemiMajorAxis() * betao2
-        * (common_consts_.eta * (2.0 + 0.5 * etasq) + elements_.Eccentricity()
+        * (common.eta * (2.0 + 0.5 * etasq) + elements_.Eccentricity()
         * (0.5 + 2.0 * etasq)
         - 2.0 * kCK2 * tsi / (elements_.RecoveredSemiMajorAxis() * psisq)
-        * (-3.0 * common_consts_.x3thm1 * (1.0 - 2.0 * eeta + etasq
+        * (-3.0 * common.x3thm1 * (1.0 - 2.0 * eeta + etasq
         * (1.5 - 0.5 * eeta))
-        + 0.75 * common_consts_.x1mth2 * (2.0 * etasq - eeta *
+        + 0.75 * common.x1mth2 * (2.0 * etasq - eeta *
             (1.0 + etasq)) * cos(2.0 * elements_.ArgumentPerigee())));
     const double theta4 = theta2 * theta2;
     const double temp1 = 3.0 * kCK2 * pinvsq * elements_.RecoveredMeanMotion();
     const double temp2 = temp1 * kCK2 * pinvsq;
     const double temp3 = 1.25 * kCK4 * pinvsq * pinvsq * elements_.RecoveredMeanMotion();
-    common_consts_.xmdot = elements_.RecoveredMeanMotion() + 0.5 * temp1 * betao *
-            common_consts_.x3thm1 + 0.0625 * temp2 * betao *
+    common.xmdot = elements_.RecoveredMeanMotion() + 0.5 * temp1 * betao *
+            common.x3thm1 + 0.0625 * temp2 * betao *
             (13.0 - 78.0 * theta2 + 137.0 * theta4);
     const double x1m5th = 1.0 - 5.0 * theta2;
-    common_consts_.omgdot = -0.5 * temp1 * x1m5th +
+    common.omgdot = -0.5 * temp1 * x1m5th +
             0.0625 * temp2 * (7.0 - 114.0 * theta2 + 395.0 * theta4) +
             temp3 * (3.0 - 36.0 * theta2 + 49.0 * theta4);
-    const double xhdot1 = -temp1 * common_consts_.cosio;
-    common_consts_.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) + 2.0 * temp3 *
-            (3.0 - 7.0 * theta2)) * common_consts_.cosio;
-    common_consts_.xnodcf = 3.5 * betao2 * xhdot1 * common_consts_.c1;
-    common_consts_.t2cof = 1.5 * common_consts_.c1;
+    const double xhdot1 = -temp1 * common.cosio;
+    common.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) + 2.0 * temp3 *
+            (3.0 - 7.0 * theta2)) * common.cosio;
+    common.xnodcf = 3.5 * betao2 * xhdot1 * common.c1;
+    common.t2cof = 1.5 * common.c1;
 
-    if (fabs(common_consts_.cosio + 1.0) > 1.5e-12)
+    if (fabs(common.cosio + 1.0) > 1.5e-12)
     {
-        common_consts_.xlcof = 0.125 * common_consts_.a3ovk2 * common_consts_.sinio * (3.0 + 5.0 * common_consts_.cosio) / (1.0 + common_consts_.cosio);
+        common.xlcof = 0.125 * common.a3ovk2 * common.sinio * (3.0 + 5.0 * common.cosio) / (1.0 + common.cosio);
     }
     else
     {
-        common_consts_.xlcof = 0.125 * common_consts_.a3ovk2 * common_consts_.sinio * (3.0 + 5.0 * common_consts_.cosio) / 1.5e-12;
+        common.xlcof = 0.125 * common.a3ovk2 * common.sinio * (3.0 + 5.0 * common.cosio) / 1.5e-12;
     }
 
-    common_consts_.aycof = 0.25 * common_consts_.a3ovk2 * common_consts_.sinio;
-    common_consts_.x7thm1 = 7.0 * theta2 - 1.0;
+    common.aycof = 0.25 * common.a3ovk2 * common.sinio;
+    common.x7thm1 = 7.0 * theta2 - 1.0;
 
     if (use_deep_space_)
     {
-        deepspace_consts_.gsto = elements_.Epoch().ToGreenwichSiderealTime();
+        deepspace_.Reset(new DeepSpaceData());
+        deepspace_->a3ovk2 = common.a3ovk2;
+        deepspace_->consts.gsto = elements_.Epoch().ToGreenwichSiderealTime();
 
-        DeepSpaceInitialise(eosq, common_consts_.sinio, common_consts_.cosio, betao,
+        /*
+         * the integrator reads the secular rates from the lane
+         */
+        MakeNearSpaceLane(common, nearspace);
+        DeepSpaceInitialise(eosq, common.sinio, common.cosio, betao,
                 theta2, betao2,
-                common_consts_.xmdot, common_consts_.omgdot, common_consts_.xnodot);
+                common.xmdot, common.omgdot, common.xnodot);
     }
     else
     {
         double c3 = 0.0;
         if (elements_.Eccentricity() > 1.0e-4)
         {
-            c3 = coef * tsi * common_consts_.a3ovk2 * elements_.RecoveredMeanMotion() * kAE *
-                    common_consts_.sinio / elements_.Eccentricity();
+            c3 = coef * tsi * common.a3ovk2 * elements_.RecoveredMeanMotion() * kAE *
+                    common.sinio / elements_.Eccentricity();
         }
 
-        nearspace_consts_.c5 = 2.0 * coef1 * elements_.RecoveredSemiMajorAxis() * betao2 * (1.0 + 2.75 *
+        nearspace.c5 = 2.0 * coef1 * elements_.RecoveredSemiMajorAxis() * betao2 * (1.0 + 2.75 *
                 (etasq + eeta) + eeta * etasq);
-        nearspace_consts_.omgcof = elements_.BStar() * c3 * cos(elements_.ArgumentPerigee());
+        nearspace.omgcof = elements_.BStar() * c3 * cos(elements_.ArgumentPerigee());
 
-        nearspace_consts_.xmcof = 0.0;
+        nearspace.xmcof = 0.0;
         if (elements_.Eccentricity() > 1.0e-4)
         {
-            nearspace_consts_.xmcof = -kTWOTHIRD * coef * elements_.BStar() * kAE / eeta;
+            nearspace.xmcof = -kTWOTHIRD * coef * elements_.BStar() * kAE / eeta;
         }
 
-        nearspace_consts_.delmo = pow(1.0 + common_consts_.eta * (cos(elements_.MeanAnomoly())), 3.0);
-        nearspace_consts_.sinmo = sin(elements_.MeanAnomoly());
+        nearspace.delmo = pow(1.0 + common.eta * (cos(elements_.MeanAnomoly())), 3.0);
+        nearspace.sinmo = sin(elements_.MeanAnomoly());
 
         if (!use_simple_model_)
         {
-            const double c1sq = common_consts_.c1 * common_consts_.c1;
-            nearspace_consts_.d2 = 4.0 * elements_.RecoveredSemiMajorAxis() * tsi * c1sq;
-            const double temp = nearspace_consts_.d2 * tsi * common_consts_.c1 / 3.0;
-            nearspace_consts_.d3 = (17.0 * elements_.RecoveredSemiMajorAxis() + s4) * temp;
-            nearspace_consts_.d4 = 0.5 * temp * elements_.RecoveredSemiMajorAxis() *
-                    tsi * (221.0 * elements_.RecoveredSemiMajorAxis() + 31.0 * s4) * common_consts_.c1;
-            nearspace_consts_.t3cof = nearspace_consts_.d2 + 2.0 * c1sq;
-            nearspace_consts_.t4cof = 0.25 * (3.0 * nearspace_consts_.d3 + common_consts_.c1 *
-                    (12.0 * nearspace_consts_.d2 + 10.0 * c1sq));
-            nearspace_consts_.t5cof = 0.2 * (3.0 * nearspace_consts_.d4 + 12.0 * common_consts_.c1 *
-                    nearspace_consts_.d3 + 6.0 * nearspace_consts_.d2 * nearspace_consts_.d2 + 15.0 *
-                    c1sq * (2.0 * nearspace_consts_.d2 + c1sq));
+            const double c1sq = common.c1 * common.c1;
+            nearspace.d2 = 4.0 * elements_.RecoveredSemiMajorAxis() * tsi * c1sq;
+            const double temp = nearspace.d2 * tsi * common.c1 / 3.0;
+            nearspace.d3 = (17.0 * elements_.RecoveredSemiMajorAxis() + s4) * temp;
+            nearspace.d4 = 0.5 * temp * elements_.RecoveredSemiMajorAxis() *
+                    tsi * (221.0 * elements_.RecoveredSemiMajorAxis() + 31.0 * s4) * common.c1;
+            nearspace.t3cof = nearspace.d2 + 2.0 * c1sq;
+            nearspace.t4cof = 0.25 * (3.0 * nearspace.d3 + common.c1 *
+                    (12.0 * nearspace.d2 + 10.0 * c1sq));
+            nearspace.t5cof = 0.2 * (3.0 * nearspace.d4 + 12.0 * common.c1 *
+                    nearspace.d3 + 6.0 * nearspace.d2 * nearspace.d2 + 15.0 *
+                    c1sq * (2.0 * nearspace.d2 + c1sq));
         }
+
+        MakeNearSpaceLane(common, nearspace);
+    }
+
+    ChoosePropagator();
+}
+
+/*
+ * choose the propagator once, so FindPosition() does not branch on
+ * the model
+ */
+void SGP4::ChoosePropagator() const
+{
+    if (use_deep_space_)
+    {
+        propagator_ = &SGP4::FindPositionSDP4;
+    }
+    else if (use_simple_model_)
+    {
+        propagator_ = &SGP4::FindPositionSGP4<true>;
+    }
+    else
+    {
+        propagator_ = &SGP4::FindPositionSGP4<false>;
     }
 }
 
@@ -224,17 +339,238 @@ Eci SGP4::FindPosition(const DateTime& dt) const
 
 Eci SGP4::FindPosition(double tsince) const
 {
+    /*
+     * integrate from epoch, so concurrent calls share no state
+     */
+    IntegratorParams params = Empty_IntegratorParams;
+    return FindPosition(tsince, params);
+}
+
+Eci SGP4::FindPosition(const DateTime& dt, IntegratorParams& params) const
+{
+    return FindPosition((dt - elements_.Epoch()).TotalMinutes(), params);
+}
+
+Eci SGP4::FindPosition(double tsince, IntegratorParams& params) const
+{
+    double position[3];
+    double velocity[3];
+
+    const SGP4Kernel::Status status = Propagate(tsince, params, NULL,
+            position, velocity);
+
+    if (status != SGP4Kernel::STATUS_OK)
+    {
+        ThrowStatus(status, tsince, position, velocity);
+    }
+
+    return MakeEci(tsince, position, velocity);
+}
+
+SGP4Kernel::Status SGP4::TryFindPosition(double tsince, Eci& eci) const
+{
+    IntegratorParams params = Empty_IntegratorParams;
+    return TryFindPosition(tsince, params, eci);
+}
+
+SGP4Kernel::Status SGP4::TryFindPosition(const DateTime& dt, Eci& eci) const
+{
+    return TryFindPosition((dt - elements_.Epoch()).TotalMinutes(), eci);
+}
+
+SGP4Kernel::Status SGP4::TryFindPosition(
+        double tsince,
+        IntegratorParams& params,
+        Eci& eci) const
+{
+    double position[3];
+    double velocity[3];
+
+    const SGP4Kernel::Status status = Propagate(tsince, params, NULL,
+            position, velocity);
+
+    if (status == SGP4Kernel::STATUS_OK
+            || status == SGP4Kernel::STATUS_DECAYED)
+    {
+        eci = MakeEci(tsince, position, velocity);
+    }
+
+    return status;
+}
+
+/**
+ * Propagate without throwing, initialising a lazy satellite first
+ * @param[in] tsince minutes since epoch
+ * @param[in,out] params the deep space integrator state
+ * @param[in,out] kepler the previous kepler solution, or NULL
+ * @param[out] position x, y, z in km
+ * @param[out] velocity x, y, z in km/s
+ * @returns the status
+ */
+SGP4Kernel::Status SGP4::Propagate(
+        const double tsince,
+        IntegratorParams& params,
+        KeplerState* kepler,
+        double* position,
+        double* velocity) const
+{
+    EnsureInitialised();
+
+    if (elements_status_ != SGP4Kernel::STATUS_OK)
+    {
+        return elements_status_;
+    }
+
+    return (this->*propagator_)(tsince, params, kepler, position, velocity);
+}
+
+Eci SGP4::MakeEci(
+        const double tsince,
+        const double* position,
+        const double* velocity) const
+{
+    return Eci(elements_.Epoch().AddMinutes(tsince),
+            Vector(position[0], position[1], position[2]),
+            Vector(velocity[0], velocity[1], velocity[2]));
+}
+
+namespace
+{
+    /*
+     * propagate one block of times of a near space satellite
+     */
+    template <bool Simple>
+    void PropagateTimes(
+            const SGP4Kernel::LaneColumns& lane,
+            const SGP4Kernel::Precision precision,
+            const double* tsince,
+            const size_t count,
+            double* position,
+            double* velocity,
+            int* status)
+    {
+        switch (precision)
+        {
+        case SGP4Kernel::PRECISION_VISUAL:
+            SGP4Kernel::PropagateNearSpaceBlock<SGP4Kernel::VisualTier,
+                Simple, true>(lane, tsince, count,
+                        position, velocity, status);
+            break;
+        case SGP4Kernel::PRECISION_FAST:
+            SGP4Kernel::PropagateNearSpaceBlock<SGP4Kernel::FastTier,
+                Simple, true>(lane, tsince, count,
+                        position, velocity, status);
+            break;
+        default:
+            SGP4Kernel::PropagateNearSpaceBlock<SGP4Kernel::ExactTier,
+                Simple, true>(lane, tsince, count,
+                        position, velocity, status);
+            break;
+        }
+    }
+}
+
+void SGP4::FindPositions(
+        const std::vector<DateTime>& dates,
+        std::vector<Eci>& positions,
+        const SGP4Kernel::Precision precision) const
+{
+    std::vector<double> tsince;
+    tsince.reserve(dates.size());
+
+    for (size_t i = 0; i < dates.size(); i++)
+    {
+        tsince.push_back((dates[i] - elements_.Epoch()).TotalMinutes());
+    }
+
+    FindPositions(tsince, positions, precision);
+}
+
+void SGP4::FindPositions(
+        const TimeGrid& grid,
+        std::vector<Eci>& positions,
+        const SGP4Kernel::Precision precision) const
+{
+    std::vector<double> tsince;
+    grid.TimesSince(elements_.Epoch(), tsince);
+
+    FindPositions(tsince, positions, precision);
+}
+
+void SGP4::FindPositions(
+        const std::vector<double>& tsince,
+        std::vector<Eci>& positions,
+        const SGP4Kernel::Precision precision) const
+{
+    EnsureInitialised();
+
+    if (elements_status_ != SGP4Kernel::STATUS_OK)
+    {
+        ThrowStatus(elements_status_, 0.0, NULL, NULL);
+    }
+
+    positions.clear();
+    positions.reserve(tsince.size());
+
     if (use_deep_space_)
     {
-        return FindPositionSDP4(tsince);
+        /*
+         * the deep space integrator steps from its previous state,
+         * so these are propagated one at a time
+         */
+        IntegratorParams params = Empty_IntegratorParams;
+        for (size_t i = 0; i < tsince.size(); i++)
+        {
+            positions.push_back(FindPosition(tsince[i], params));
+        }
+        return;
     }
-    else
+
+    /*
+     * every lane of a block reads the one satellite
+     */
+    const SGP4Kernel::LaneColumns lane(lane_);
+
+    void (*propagate)(const SGP4Kernel::LaneColumns&,
+            const SGP4Kernel::Precision, const double*, const size_t,
+            double*, double*, int*) = use_simple_model_
+        ? &PropagateTimes<true>
+        : &PropagateTimes<false>;
+
+    double position[3 * SGP4Kernel::kBlockSize];
+    double velocity[3 * SGP4Kernel::kBlockSize];
+    int status[SGP4Kernel::kBlockSize];
+
+    for (size_t begin = 0; begin < tsince.size();
+            begin += SGP4Kernel::kBlockSize)
     {
-        return FindPositionSGP4(tsince);
+        const size_t count = std::min(SGP4Kernel::kBlockSize,
+                tsince.size() - begin);
+
+        propagate(lane, precision, &tsince[begin], count,
+                position, velocity, status);
+
+        for (size_t j = 0; j < count; j++)
+        {
+            const double* pos = position + 3 * j;
+            const double* vel = velocity + 3 * j;
+
+            if (status[j] != SGP4Kernel::STATUS_OK)
+            {
+                ThrowStatus(status[j], tsince[begin + j], pos, vel);
+            }
+
+            positions.push_back(MakeEci(tsince[begin + j], pos, vel));
+        }
     }
 }
 
-Eci SGP4::FindPositionSDP4(double tsince) const
+SGP4Kernel::Status SGP4::FindPositionSDP4(
+        const double tsince,
+        IntegratorParams& params,
+        KeplerState* kepler,
+        double* position,
+        double* velocity) const
 {
     /*
      * the final values
@@ -250,27 +586,27 @@ Eci SGP4::FindPositionSDP4(double tsince) const
      * update for secular gravity and atmospheric drag
      */
     double xmdf = elements_.MeanAnomoly()
-        + common_consts_.xmdot * tsince;
+        + lane_.xmdot * tsince;
     double omgadf = elements_.ArgumentPerigee()
-        + common_consts_.omgdot * tsince;
+        + lane_.omgdot * tsince;
     const double xnoddf = elements_.AscendingNode()
-        + common_consts_.xnodot * tsince;
+        + lane_.xnodot * tsince;
 
     const double tsq = tsince * tsince;
-    xnode = xnoddf + common_consts_.xnodcf * tsq;
-    double tempa = 1.0 - common_consts_.c1 * tsince;
-    double tempe = elements_.BStar() * common_consts_.c4 * tsince;
-    double templ = common_consts_.t2cof * tsq;
+    xnode = xnoddf + lane_.xnodcf * tsq;
+    double tempa = 1.0 - lane_.c1 * tsince;
+    double tempe = elements_.BStar() * lane_.c4 * tsince;
+    double templ = lane_.t2cof * tsq;
 
     double xn = elements_.RecoveredMeanMotion();
     e = elements_.Eccentricity();
     xincl = elements_.Inclination();
 
-    DeepSpaceSecular(tsince, xmdf, omgadf, xnode, e, xincl, xn);
+    DeepSpaceSecular(tsince, xmdf, omgadf, xnode, e, xincl, xn, params);
 
     if (xn <= 0.0)
     {
-        throw SatelliteException("Error: (xn <= 0.0)");
+        return SGP4Kernel::STATUS_MEAN_MOTION;
     }
 
     a = pow(kXKE / xn, kTWOTHIRD) * tempa * tempa;
@@ -298,7 +634,7 @@ Eci SGP4::FindPositionSDP4(double tsince) const
      */
     if (e <= -0.001)
     {
-        throw SatelliteException("Error: (e <= -0.001)");
+        return SGP4Kernel::STATUS_ECCENTRICITY;
     }
     else if (e < 1.0e-6)
     {
@@ -324,30 +660,37 @@ Eci SGP4::FindPositionSDP4(double tsince) const
     double perturbed_xlcof;
     if (fabs(perturbed_cosio + 1.0) > 1.5e-12)
     {
-        perturbed_xlcof = 0.125 * common_consts_.a3ovk2 * perturbed_sinio
+        perturbed_xlcof = 0.125 * deepspace_->a3ovk2 * perturbed_sinio
             * (3.0 + 5.0 * perturbed_cosio) / (1.0 + perturbed_cosio);
     }
     else
     {
-        perturbed_xlcof = 0.125 * common_consts_.a3ovk2 * perturbed_sinio
+        perturbed_xlcof = 0.125 * deepspace_->a3ovk2 * perturbed_sinio
             * (3.0 + 5.0 * perturbed_cosio) / 1.5e-12;
     }
 
-    const double perturbed_aycof = 0.25 * common_consts_.a3ovk2
+    const double perturbed_aycof = 0.25 * deepspace_->a3ovk2
         * perturbed_sinio;
 
     /*
      * using calculated values, find position and velocity
      */
-    return CalculateFinalPositionVelocity(tsince, e,
+    return CalculateFinalPositionVelocity(e,
             a, omega, xl, xnode,
             xincl, perturbed_xlcof, perturbed_aycof,
             perturbed_x3thm1, perturbed_x1mth2, perturbed_x7thm1,
-            perturbed_cosio, perturbed_sinio);
+            perturbed_cosio, perturbed_sinio, kepler,
+            position, velocity);
 
 }
 
-Eci SGP4::FindPositionSGP4(double tsince) const
+template <bool Simple>
+SGP4Kernel::Status SGP4::FindPositionSGP4(
+        double tsince,
+        IntegratorParams&,
+        KeplerState* kepler,
+        double* position,
+        double* velocity) const
 {
     /*
      * the final values
@@ -357,84 +700,117 @@ Eci SGP4::FindPositionSGP4(double tsince) const
     double omega;
     double xl;
     double xnode;
-    double xincl;
 
     /*
      * update for secular gravity and atmospheric drag
      */
-    const double xmdf = elements_.MeanAnomoly()
-        + common_consts_.xmdot * tsince;
-    const double omgadf = elements_.ArgumentPerigee()
-        + common_consts_.omgdot * tsince;
-    const double xnoddf = elements_.AscendingNode()
-        + common_consts_.xnodot * tsince;
-
-    const double tsq = tsince * tsince;
-    xnode = xnoddf + common_consts_.xnodcf * tsq;
-    double tempa = 1.0 - common_consts_.c1 * tsince;
-    double tempe = elements_.BStar() * common_consts_.c4 * tsince;
-    double templ = common_consts_.t2cof * tsq;
-
-    xincl = elements_.Inclination();
-    omega = omgadf;
-    double xmp = xmdf;
-
-    if (!use_simple_model_)
-    {
-        const double delomg = nearspace_consts_.omgcof * tsince;
-        const double delm = nearspace_consts_.xmcof
-            * (pow(1.0 + common_consts_.eta * cos(xmdf), 3.0)
-                    * - nearspace_consts_.delmo);
-        const double temp = delomg + delm;
-
-        xmp += temp;
-        omega -= temp;
-
-        const double tcube = tsq * tsince;
-        const double tfour = tsince * tcube;
-
-        tempa = tempa - nearspace_consts_.d2 * tsq - nearspace_consts_.d3
-            * tcube - nearspace_consts_.d4 * tfour;
-        tempe += elements_.BStar() * nearspace_consts_.c5
-            * (sin(xmp) - nearspace_consts_.sinmo);
-        templ += nearspace_consts_.t3cof * tcube + tfour
-            * (nearspace_consts_.t4cof + tsince * nearspace_consts_.t5cof);
-    }
-
-    a = elements_.RecoveredSemiMajorAxis() * tempa * tempa;
-    e = elements_.Eccentricity() - tempe;
-    xl = xmp + omega + xnode + elements_.RecoveredMeanMotion() * templ;
-
-    /*
-     * fix tolerance for error recognition
-     */
-    if (e <= -0.001)
-    {
-        throw SatelliteException("Error: (e <= -0.001)");
-    }
-    else if (e < 1.0e-6)
-    {
-        e = 1.0e-6;
-    }
-    else if (e > (1.0 - 1.0e-6))
+    const SGP4Kernel::LaneColumns lane(lane_);
+    const int status = SGP4Kernel::NearSpaceSecular<
+        SGP4Kernel::ExactTier, Simple>(lane, 0, tsince,
+                e, a, omega, xl, xnode);
+    if (status != SGP4Kernel::STATUS_OK)
     {
-        e = 1.0 - 1.0e-6;
+        return static_cast<SGP4Kernel::Status>(status);
     }
 
     /*
      * using calculated values, find position and velocity
      * we can pass in constants from Initialise() as these dont change
      */
-    return CalculateFinalPositionVelocity(tsince, e,
+    return CalculateFinalPositionVelocity(e,
             a, omega, xl, xnode,
-            xincl, common_consts_.xlcof, common_consts_.aycof,
-            common_consts_.x3thm1, common_consts_.x1mth2, common_consts_.x7thm1,
-            common_consts_.cosio, common_consts_.sinio);
+            elements_.Inclination(), lane_.xlcof, lane_.aycof,
+            lane_.x3thm1, lane_.x1mth2, lane_.x7thm1,
+            lane_.cosio, lane_.sinio, kepler,
+            position, velocity);
 
 }
 
 /**
- * @param[in] tsince
+ * @returns the constants used by the near space kernel
+ */
+void SGP4::MakeNearSpaceLane(
+        const CommonConstants& common,
+        const NearSpaceConstants& nearspace) const
+{
+    SGP4Kernel::NearSpaceLane& lane = lane_;
+
+    lane.xmo = elements_.MeanAnomoly();
+    lane.omegao = elements_.ArgumentPerigee();
+    lane.xnodeo = elements_.AscendingNode();
+    lane.eo = elements_.Eccentricity();
+    lane.xincl = elements_.Inclination();
+    lane.bstar = elements_.BStar();
+    lane.aodp = elements_.RecoveredSemiMajorAxis();
+    lane.xnodp = elements_.RecoveredMeanMotion();
+
+    lane.xmdot = common.xmdot;
+    lane.omgdot = common.omgdot;
+    lane.xnodot = common.xnodot;
+    lane.xnodcf = common.xnodcf;
+    lane.c1 = common.c1;
+    lane.c4 = common.c4;
+    lane.t2cof = common.t2cof;
+
+    lane.eta = common.eta;
+    lane.omgcof = nearspace.omgcof;
+    lane.xmcof = nearspace.xmcof;
+    lane.delmo = nearspace.delmo;
+    lane.sinmo = nearspace.sinmo;
+    lane.c5 = nearspace.c5;
+    lane.d2 = nearspace.d2;
+    lane.d3 = nearspace.d3;
+    lane.d4 = nearspace.d4;
+    lane.t3cof = nearspace.t3cof;
+    lane.t4cof = nearspace.t4cof;
+    lane.t5cof = nearspace.t5cof;
+
+    lane.xlcof = common.xlcof;
+    lane.aycof = common.aycof;
+    lane.x3thm1 = common.x3thm1;
+    lane.x1mth2 = common.x1mth2;
+    lane.x7thm1 = common.x7thm1;
+    lane.cosio = common.cosio;
+    lane.sinio = common.sinio;
+
+}
+
+/**
+ * Throw the exception FindPosition() reports for a status
+ * @param[in] status the status, not STATUS_OK
+ * @param[in] tsince minutes since epoch
+ * @param[in] position the position, used when decayed
+ * @param[in] velocity the velocity, used when decayed
+ */
+void SGP4::ThrowStatus(
+        const int status,
+        const double tsince,
+        const double* position,
+        const double* velocity) const
+{
+    switch (status)
+    {
+    case SGP4Kernel::STATUS_ECCENTRICITY:
+        throw SatelliteException("Error: (e <= -0.001)");
+    case SGP4Kernel::STATUS_ELSQ:
+        throw SatelliteException("Error: (elsq >= 1.0)");
+    case SGP4Kernel::STATUS_PL:
+        throw SatelliteException("Error: (pl < 0.0)");
+    case SGP4Kernel::STATUS_MEAN_MOTION:
+        throw SatelliteException("Error: (xn <= 0.0)");
+    case SGP4Kernel::STATUS_ECCENTRICITY_RANGE:
+        throw SatelliteException("Eccentricity out of range");
+    case SGP4Kernel::STATUS_INCLINATION_RANGE:
+        throw SatelliteException("Inclination out of range");
+    default:
+        throw DecayedException(
+                elements_.Epoch().AddMinutes(tsince),
+                Vector(position[0], position[1], position[2]),
+                Vector(velocity[0], velocity[1], velocity[2]));
+    }
+}
+
+/**
  * @param[in] e
  * @param[in] a
  * @param[in] omega
@@ -448,10 +824,12 @@ Eci SGP4::FindPositionSGP4(double tsince) const
  * @param[in] x7thm1
  * @param[in] cosio
  * @param[in] sinio
- * @returns Eci result
+ * @param[in,out] kepler the previous solution to start from, or NULL
+ * @param[out] position x, y, z in km
+ * @param[out] velocity x, y, z in km/s
+ * @returns the status
  */
-Eci SGP4::CalculateFinalPositionVelocity(
-        const double tsince,
+SGP4Kernel::Status SGP4::CalculateFinalPositionVelocity(
         const double e,
         const double a,
         const double omega,
@@ -464,24 +842,24 @@ Eci SGP4::CalculateFinalPositionVelocity(
         const double x1mth2,
         const double x7thm1,
         const double cosio,
-        const double sinio) const
+        const double sinio,
+        KeplerState* kepler,
+        double* position,
+        double* velocity) const
 {
-    const double beta2 = 1.0 - e * e;
-    const double xn = kXKE / pow(a, 1.5);
     /*
      * long period periodics
      */
-    const double axn = e * cos(omega);
-    const double temp11 = 1.0 / (a * beta2);
-    const double xll = temp11 * xlcof * axn;
-    const double aynl = temp11 * aycof;
-    const double xlt = xl + xll;
-    const double ayn = e * sin(omega) + aynl;
-    const double elsq = axn * axn + ayn * ayn;
-
-    if (elsq >= 1.0)
+    double axn;
+    double ayn;
+    double capu;
+    double elsq;
+
+    if (SGP4Kernel::LongPeriodic<SGP4Kernel::ExactTier>(e, a, omega,
+                xl, xnode, xlcof, aycof,
+                axn, ayn, capu, elsq) != SGP4Kernel::STATUS_OK)
     {
-        throw SatelliteException("Error: (elsq >= 1.0)");
+        return SGP4Kernel::STATUS_ELSQ;
     }
 
     /*
@@ -489,12 +867,24 @@ Eci SGP4::CalculateFinalPositionVelocity(
      * - solve using Newton-Raphson root solving
      * - here capu is almost the mean anomoly
      * - initialise the eccentric anomaly term epw
-     * - The fmod saves reduction of angle to +/-2pi in sin/cos() and prevents
-     * convergence problems.
      */
-    const double capu = fmod(xlt - xnode, kTWOPI);
     double epw = capu;
 
+    if (kepler != NULL && kepler->valid)
+    {
+        /*
+         * start from the last solution, moved along by the change in
+         * capu: d(epw - capu) / d(capu) = ecose / (1 - ecose)
+         */
+        const double dcapu = Util::WrapNegPosPI(capu - kepler->capu);
+
+        if (fabs(dcapu) < kMaxKeplerWarmStep)
+        {
+            epw = capu + Util::WrapNegPosPI(kepler->epw - kepler->capu)
+                + dcapu * kepler->ecose / (1.0 - kepler->ecose);
+        }
+    }
+
     double sinepw = 0.0;
     double cosepw = 0.0;
     double ecose = 0.0;
@@ -507,130 +897,30 @@ Eci SGP4::CalculateFinalPositionVelocity(
 
     bool kepler_running = true;
 
-    for (int i = 0; i < 10 && kepler_running; i++)
+    for (int i = 0; i < SGP4Kernel::kKeplerIterations && kepler_running; i++)
     {
-        sinepw = sin(epw);
-        cosepw = cos(epw);
-        ecose = axn * cosepw + ayn * sinepw;
-        esine = axn * sinepw - ayn * cosepw;
-
-        double f = capu - epw + esine;
-
-        if (fabs(f) < 1.0e-12)
-        {
-            kepler_running = false;
-        }
-        else
-        {
-            /*
-             * 1st order Newton-Raphson correction
-             */
-            const double fdot = 1.0 - ecose;
-            double delta_epw = f / fdot;
-
-            /*
-             * 2nd order Newton-Raphson correction.
-             * f / (fdot - 0.5 * d2f * f/fdot)
-             */
-            if (i == 0)
-            {
-                if (delta_epw > max_newton_naphson)
-                {
-                    delta_epw = max_newton_naphson;
-                }
-                else if (delta_epw < -max_newton_naphson)
-                {
-                    delta_epw = -max_newton_naphson;
-                }
-            }
-            else
-            {
-                delta_epw = f / (fdot + 0.5 * esine * delta_epw);
-            }
-
-            /*
-             * Newton-Raphson correction of -F/DF
-             */
-            epw += delta_epw;
-        }
+        kepler_running = !SGP4Kernel::KeplerStep<SGP4Kernel::ExactTier>(i,
+                capu, axn, ayn, max_newton_naphson,
+                epw, sinepw, cosepw, ecose, esine);
     }
-    /*
-     * short period preliminary quantities
-     */
-    const double temp21 = 1.0 - elsq;
-    const double pl = a * temp21;
 
-    if (pl < 0.0)
+    if (kepler != NULL)
     {
-        throw SatelliteException("Error: (pl < 0.0)");
+        kepler->valid = !kepler_running;
+        kepler->capu = capu;
+        kepler->epw = epw;
+        kepler->ecose = ecose;
     }
 
-    const double r = a * (1.0 - ecose);
-    const double temp31 = 1.0 / r;
-    const double rdot = kXKE * sqrt(a) * esine * temp31;
-    const double rfdot = kXKE * sqrt(pl) * temp31;
-    const double temp32 = a * temp31;
-    const double betal = sqrt(temp21);
-    const double temp33 = 1.0 / (1.0 + betal);
-    const double cosu = temp32 * (cosepw - axn + ayn * esine * temp33);
-    const double sinu = temp32 * (sinepw - ayn - axn * esine * temp33);
-    const double u = atan2(sinu, cosu);
-    const double sin2u = 2.0 * sinu * cosu;
-    const double cos2u = 2.0 * cosu * cosu - 1.0;
-
-    /*
-     * update for short periodics
-     */
-    const double temp41 = 1.0 / pl;
-    const double temp42 = kCK2 * temp41;
-    const double temp43 = temp42 * temp41;
-
-    const double rk = r * (1.0 - 1.5 * temp43 * betal * x3thm1)
-        + 0.5 * temp42 * x1mth2 * cos2u;
-    const double uk = u - 0.25 * temp43 * x7thm1 * sin2u;
-    const double xnodek = xnode + 1.5 * temp43 * cosio * sin2u;
-    const double xinck = xincl + 1.5 * temp43 * cosio * sinio * cos2u;
-    const double rdotk = rdot - xn * temp42 * x1mth2 * sin2u;
-    const double rfdotk = rfdot + xn * temp42 * (x1mth2 * cos2u + 1.5 * x3thm1);
-
     /*
-     * orientation vectors
+     * short periodics, position and velocity
      */
-    const double sinuk = sin(uk);
-    const double cosuk = cos(uk);
-    const double sinik = sin(xinck);
-    const double cosik = cos(xinck);
-    const double sinnok = sin(xnodek);
-    const double cosnok = cos(xnodek);
-    const double xmx = -sinnok * cosik;
-    const double xmy = cosnok * cosik;
-    const double ux = xmx * sinuk + cosnok * cosuk;
-    const double uy = xmy * sinuk + sinnok * cosuk;
-    const double uz = sinik * sinuk;
-    const double vx = xmx * cosuk - cosnok * sinuk;
-    const double vy = xmy * cosuk - sinnok * sinuk;
-    const double vz = sinik * cosuk;
-    /*
-     * position and velocity
-     */
-    const double x = rk * ux * kXKMPER;
-    const double y = rk * uy * kXKMPER;
-    const double z = rk * uz * kXKMPER;
-    Vector position(x, y, z);
-    const double xdot = (rdotk * ux + rfdotk * vx) * kXKMPER / 60.0;
-    const double ydot = (rdotk * uy + rfdotk * vy) * kXKMPER / 60.0;
-    const double zdot = (rdotk * uz + rfdotk * vz) * kXKMPER / 60.0;
-    Vector velocity(xdot, ydot, zdot);
-
-    if (rk < 1.0)
-    {
-        throw DecayedException(
-                elements_.Epoch().AddMinutes(tsince),
-                position,
-                velocity);
-    }
-
-    return Eci(elements_.Epoch().AddMinutes(tsince), position, velocity);
+    return static_cast<SGP4Kernel::Status>(
+            SGP4Kernel::ShortPeriodic<SGP4Kernel::ExactTier>(
+                a, xnode, xincl,
+                axn, ayn, elsq, sinepw, cosepw, ecose, esine,
+                x3thm1, x1mth2, x7thm1, cosio, sinio,
+                position, velocity));
 }
 
 /**
@@ -672,7 +962,7 @@ void SGP4::DeepSpaceInitialise(
         const double betao2,
         const double xmdot,
         const double omgdot,
-        const double xnodot)
+        const double xnodot) const
 {
     double se = 0.0;
     double si = 0.0;
@@ -723,7 +1013,7 @@ void SGP4::DeepSpaceInitialise(
     const double zcoshl = sqrt(1.0 - zsinhl * zsinhl);
     const double c = 4.7199672 + 0.22997150 * jday;
     const double gam = 5.8351514 + 0.0019443680 * jday;
-    deepspace_consts_.zmol = Util::WrapTwoPI(c - gam);
+    deepspace_->consts.zmol = Util::WrapTwoPI(c - gam);
     double zx = 0.39785416 * stem / zsinil;
     double zy = zcoshl * ctem + 0.91744867 * zsinhl * stem;
     zx = atan2(zx, zy);
@@ -731,7 +1021,7 @@ void SGP4::DeepSpaceInitialise(
 
     const double zcosgl = cos(zx);
     const double zsingl = sin(zx);
-    deepspace_consts_.zmos = Util::WrapTwoPI(6.2565837 + 0.017201977 * jday);
+    deepspace_->consts.zmos = Util::WrapTwoPI(6.2565837 + 0.017201977 * jday);
 
     /*
      * do solar terms
@@ -823,18 +1113,18 @@ void SGP4::DeepSpaceInitialise(
             shdq = (-zn * s2 * (z21 + z23)) / sinio;
         }
 
-        deepspace_consts_.ee2 = 2.0 * s1 * s6;
-        deepspace_consts_.e3 = 2.0 * s1 * s7;
-        deepspace_consts_.xi2 = 2.0 * s2 * z12;
-        deepspace_consts_.xi3 = 2.0 * s2 * (z13 - z11);
-        deepspace_consts_.xl2 = -2.0 * s3 * z2;
-        deepspace_consts_.xl3 = -2.0 * s3 * (z3 - z1);
-        deepspace_consts_.xl4 = -2.0 * s3 * (-21.0 - 9.0 * eosq) * ze;
-        deepspace_consts_.xgh2 = 2.0 * s4 * z32;
-        deepspace_consts_.xgh3 = 2.0 * s4 * (z33 - z31);
-        deepspace_consts_.xgh4 = -18.0 * s4 * ze;
-        deepspace_consts_.xh2 = -2.0 * s2 * z22;
-        deepspace_consts_.xh3 = -2.0 * s2 * (z23 - z21);
+        deepspace_->consts.ee2 = 2.0 * s1 * s6;
+        deepspace_->consts.e3 = 2.0 * s1 * s7;
+        deepspace_->consts.xi2 = 2.0 * s2 * z12;
+        deepspace_->consts.xi3 = 2.0 * s2 * (z13 - z11);
+        deepspace_->consts.xl2 = -2.0 * s3 * z2;
+        deepspace_->consts.xl3 = -2.0 * s3 * (z3 - z1);
+        deepspace_->consts.xl4 = -2.0 * s3 * (-21.0 - 9.0 * eosq) * ze;
+        deepspace_->consts.xgh2 = 2.0 * s4 * z32;
+        deepspace_->consts.xgh3 = 2.0 * s4 * (z33 - z31);
+        deepspace_->consts.xgh4 = -18.0 * s4 * ze;
+        deepspace_->consts.xh2 = -2.0 * s2 * z22;
+        deepspace_->consts.xh3 = -2.0 * s2 * (z23 - z21);
 
         if (cnt == 1)
         {
@@ -843,23 +1133,23 @@ void SGP4::DeepSpaceInitialise(
         /*
          * do lunar terms
          */
-        deepspace_consts_.sse = se;
-        deepspace_consts_.ssi = si;
-        deepspace_consts_.ssl = sl;
-        deepspace_consts_.ssh = shdq;
-        deepspace_consts_.ssg = sgh - cosio * deepspace_consts_.ssh;
-        deepspace_consts_.se2 = deepspace_consts_.ee2;
-        deepspace_consts_.si2 = deepspace_consts_.xi2;
-        deepspace_consts_.sl2 = deepspace_consts_.xl2;
-        deepspace_consts_.sgh2 = deepspace_consts_.xgh2;
-        deepspace_consts_.sh2 = deepspace_consts_.xh2;
-        deepspace_consts_.se3 = deepspace_consts_.e3;
-        deepspace_consts_.si3 = deepspace_consts_.xi3;
-        deepspace_consts_.sl3 = deepspace_consts_.xl3;
-        deepspace_consts_.sgh3 = deepspace_consts_.xgh3;
-        deepspace_consts_.sh3 = deepspace_consts_.xh3;
-        deepspace_consts_.sl4 = deepspace_consts_.xl4;
-        deepspace_consts_.sgh4 = deepspace_consts_.xgh4;
+        deepspace_->consts.sse = se;
+        deepspace_->consts.ssi = si;
+        deepspace_->consts.ssl = sl;
+        deepspace_->consts.ssh = shdq;
+        deepspace_->consts.ssg = sgh - cosio * deepspace_->consts.ssh;
+        deepspace_->consts.se2 = deepspace_->consts.ee2;
+        deepspace_->consts.si2 = deepspace_->consts.xi2;
+        deepspace_->consts.sl2 = deepspace_->consts.xl2;
+        deepspace_->consts.sgh2 = deepspace_->consts.xgh2;
+        deepspace_->consts.sh2 = deepspace_->consts.xh2;
+        deepspace_->consts.se3 = deepspace_->consts.e3;
+        deepspace_->consts.si3 = deepspace_->consts.xi3;
+        deepspace_->consts.sl3 = deepspace_->consts.xl3;
+        deepspace_->consts.sgh3 = deepspace_->consts.xgh3;
+        deepspace_->consts.sh3 = deepspace_->consts.xh3;
+        deepspace_->consts.sl4 = deepspace_->consts.xl4;
+        deepspace_->consts.sgh4 = deepspace_->consts.xgh4;
         zcosg = zcosgl;
         zsing = zsingl;
         zcosi = zcosil;
@@ -871,14 +1161,14 @@ void SGP4::DeepSpaceInitialise(
         ze = ZEL;
     }
 
-    deepspace_consts_.sse += se;
-    deepspace_consts_.ssi += si;
-    deepspace_consts_.ssl += sl;
-    deepspace_consts_.ssg += sgh - cosio * shdq;
-    deepspace_consts_.ssh += shdq;
+    deepspace_->consts.sse += se;
+    deepspace_->consts.ssi += si;
+    deepspace_->consts.ssl += sl;
+    deepspace_->consts.ssg += sgh - cosio * shdq;
+    deepspace_->consts.ssh += shdq;
 
-    deepspace_consts_.resonance_flag = false;
-    deepspace_consts_.synchronous_flag = false;
+    deepspace_->consts.resonance_flag = false;
+    deepspace_->consts.synchronous_flag = false;
     bool initialise_integrator = true;
 
     if (elements_.RecoveredMeanMotion() < 0.0052359877
@@ -887,8 +1177,8 @@ void SGP4::DeepSpaceInitialise(
         /*
          * 24h synchronous resonance terms initialisation
          */
-        deepspace_consts_.resonance_flag = true;
-        deepspace_consts_.synchronous_flag = true;
+        deepspace_->consts.resonance_flag = true;
+        deepspace_->consts.synchronous_flag = true;
 
         const double g200 = 1.0 + eosq * (-2.5 + 0.8125 * eosq);
         const double g310 = 1.0 + 2.0 * eosq;
@@ -898,24 +1188,24 @@ void SGP4::DeepSpaceInitialise(
             - 0.75 * (1.0 + cosio);
         double f330 = 1.0 + cosio;
         f330 = 1.875 * f330 * f330 * f330;
-        deepspace_consts_.del1 = 3.0 * elements_.RecoveredMeanMotion()
+        deepspace_->consts.del1 = 3.0 * elements_.RecoveredMeanMotion()
             * elements_.RecoveredMeanMotion()
             * aqnv * aqnv;
-        deepspace_consts_.del2 = 2.0 * deepspace_consts_.del1
+        deepspace_->consts.del2 = 2.0 * deepspace_->consts.del1
             * f220 * g200 * Q22;
-        deepspace_consts_.del3 = 3.0 * deepspace_consts_.del1
+        deepspace_->consts.del3 = 3.0 * deepspace_->consts.del1
             * f330 * g300 * Q33 * aqnv;
-        deepspace_consts_.del1 = deepspace_consts_.del1
+        deepspace_->consts.del1 = deepspace_->consts.del1
             * f311 * g310 * Q31 * aqnv;
 
-        integrator_consts_.xlamo = elements_.MeanAnomoly()
+        deepspace_->integrator.xlamo = elements_.MeanAnomoly()
             + elements_.AscendingNode()
             + elements_.ArgumentPerigee()
-            - deepspace_consts_.gsto;
+            - deepspace_->consts.gsto;
         bfact = xmdot + xpidot - kTHDT;
-        bfact += deepspace_consts_.ssl
-            + deepspace_consts_.ssg
-            + deepspace_consts_.ssh;
+        bfact += deepspace_->consts.ssl
+            + deepspace_->consts.ssg
+            + deepspace_->consts.ssh;
     }
     else if (elements_.RecoveredMeanMotion() < 8.26e-3
             || elements_.RecoveredMeanMotion() > 9.24e-3
@@ -928,7 +1218,7 @@ void SGP4::DeepSpaceInitialise(
         /*
          * geopotential resonance initialisation for 12 hour orbits
          */
-        deepspace_consts_.resonance_flag = true;
+        deepspace_->consts.resonance_flag = true;
 
         double g211;
         double g310;
@@ -1026,35 +1316,35 @@ void SGP4::DeepSpaceInitialise(
 
         double temp1 = 3.0 * xno2 * ainv2;
         double temp = temp1 * ROOT22;
-        deepspace_consts_.d2201 = temp * f220 * g201;
-        deepspace_consts_.d2211 = temp * f221 * g211;
+        deepspace_->consts.d2201 = temp * f220 * g201;
+        deepspace_->consts.d2211 = temp * f221 * g211;
         temp1 = temp1 * aqnv;
         temp = temp1 * ROOT32;
-        deepspace_consts_.d3210 = temp * f321 * g310;
-        deepspace_consts_.d3222 = temp * f322 * g322;
+        deepspace_->consts.d3210 = temp * f321 * g310;
+        deepspace_->consts.d3222 = temp * f322 * g322;
         temp1 = temp1 * aqnv;
         temp = 2.0 * temp1 * ROOT44;
-        deepspace_consts_.d4410 = temp * f441 * g410;
-        deepspace_consts_.d4422 = temp * f442 * g422;
+        deepspace_->consts.d4410 = temp * f441 * g410;
+        deepspace_->consts.d4422 = temp * f442 * g422;
         temp1 = temp1 * aqnv;
         temp = temp1 * ROOT52;
-        deepspace_consts_.d5220 = temp * f522 * g520;
-        deepspace_consts_.d5232 = temp * f523 * g532;
+        deepspace_->consts.d5220 = temp * f522 * g520;
+        deepspace_->consts.d5232 = temp * f523 * g532;
         temp = 2.0 * temp1 * ROOT54;
-        deepspace_consts_.d5421 = temp * f542 * g521;
-        deepspace_consts_.d5433 = temp * f543 * g533;
+        deepspace_->consts.d5421 = temp * f542 * g521;
+        deepspace_->consts.d5433 = temp * f543 * g533;
 
-        integrator_consts_.xlamo = elements_.MeanAnomoly()
+        deepspace_->integrator.xlamo = elements_.MeanAnomoly()
             + elements_.AscendingNode()
             + elements_.AscendingNode()
-            - deepspace_consts_.gsto
-            - deepspace_consts_.gsto;
+            - deepspace_->consts.gsto
+            - deepspace_->consts.gsto;
         bfact = xmdot
             + xnodot + xnodot
             - kTHDT - kTHDT;
-        bfact = bfact + deepspace_consts_.ssl
-            + deepspace_consts_.ssh
-            + deepspace_consts_.ssh;
+        bfact = bfact + deepspace_->consts.ssl
+            + deepspace_->consts.ssh
+            + deepspace_->consts.ssh;
     }
 
     if (initialise_integrator)
@@ -1062,14 +1352,37 @@ void SGP4::DeepSpaceInitialise(
         /*
          * initialise integrator
          */
-        integrator_consts_.xfact = bfact - elements_.RecoveredMeanMotion();
-        integrator_params_.atime = 0.0;
-        integrator_params_.xni = elements_.RecoveredMeanMotion();
-        integrator_params_.xli = integrator_consts_.xlamo;
+        deepspace_->integrator.xfact = bfact - elements_.RecoveredMeanMotion();
+        IntegratorParams params = Empty_IntegratorParams;
+        params.atime = 0.0;
+        params.xni = elements_.RecoveredMeanMotion();
+        params.xli = deepspace_->integrator.xlamo;
         /*
          * precompute dot terms for epoch
          */
-        DeepSpaceCalcDotTerms(integrator_consts_.values_0);
+        DeepSpaceCalcDotTerms(params, deepspace_->integrator.values_0);
+        params.values_t = deepspace_->integrator.values_0;
+
+        /*
+         * integrate away from epoch in both directions, keeping the state
+         * after every step
+         */
+        deepspace_->forward.push_back(params);
+        deepspace_->backward.push_back(params);
+        for (int i = 0; i < kIntegratorCheckpoints; i++)
+        {
+            IntegratorParams forward = deepspace_->forward.back();
+            DeepSpaceIntegrator(kIntegratorStep, kIntegratorStep2,
+                    forward.values_t, forward);
+            DeepSpaceCalcDotTerms(forward, forward.values_t);
+            deepspace_->forward.push_back(forward);
+
+            IntegratorParams backward = deepspace_->backward.back();
+            DeepSpaceIntegrator(-kIntegratorStep, kIntegratorStep2,
+                    backward.values_t, backward);
+            DeepSpaceCalcDotTerms(backward, backward.values_t);
+            deepspace_->backward.push_back(backward);
+        }
     }
 }
 
@@ -1098,46 +1411,46 @@ void SGP4::DeepSpaceCalculateLunarSolarTerms(
     /*
      * calculate solar terms for time tsince
      */
-    double zm = deepspace_consts_.zmos + ZNS * tsince;
+    double zm = deepspace_->consts.zmos + ZNS * tsince;
     double zf = zm + 2.0 * ZES * sin(zm);
     double sinzf = sin(zf);
     double f2 = 0.5 * sinzf * sinzf - 0.25;
     double f3 = -0.5 * sinzf * cos(zf);
 
-    const double ses = deepspace_consts_.se2 * f2
-        + deepspace_consts_.se3 * f3;
-    const double sis = deepspace_consts_.si2 * f2
-        + deepspace_consts_.si3 * f3;
-    const double sls = deepspace_consts_.sl2 * f2
-        + deepspace_consts_.sl3 * f3
-        + deepspace_consts_.sl4 * sinzf;
-    const double sghs = deepspace_consts_.sgh2 * f2
-        + deepspace_consts_.sgh3 * f3
-        + deepspace_consts_.sgh4 * sinzf;
-    const double shs = deepspace_consts_.sh2 * f2
-        + deepspace_consts_.sh3 * f3;
+    const double ses = deepspace_->consts.se2 * f2
+        + deepspace_->consts.se3 * f3;
+    const double sis = deepspace_->consts.si2 * f2
+        + deepspace_->consts.si3 * f3;
+    const double sls = deepspace_->consts.sl2 * f2
+        + deepspace_->consts.sl3 * f3
+        + deepspace_->consts.sl4 * sinzf;
+    const double sghs = deepspace_->consts.sgh2 * f2
+        + deepspace_->consts.sgh3 * f3
+        + deepspace_->consts.sgh4 * sinzf;
+    const double shs = deepspace_->consts.sh2 * f2
+        + deepspace_->consts.sh3 * f3;
 
     /*
      * calculate lunar terms for time tsince
      */
-    zm = deepspace_consts_.zmol + ZNL * tsince;
+    zm = deepspace_->consts.zmol + ZNL * tsince;
     zf = zm + 2.0 * ZEL * sin(zm);
     sinzf = sin(zf);
     f2 = 0.5 * sinzf * sinzf - 0.25;
     f3 = -0.5 * sinzf * cos(zf);
 
-    const double sel = deepspace_consts_.ee2 * f2
-        + deepspace_consts_.e3 * f3;
-    const double sil = deepspace_consts_.xi2 * f2
-        + deepspace_consts_.xi3 * f3;
-    const double sll = deepspace_consts_.xl2 * f2
-        + deepspace_consts_.xl3 * f3
-        + deepspace_consts_.xl4 * sinzf;
-    const double sghl = deepspace_consts_.xgh2 * f2
-        + deepspace_consts_.xgh3 * f3
-        + deepspace_consts_.xgh4 * sinzf;
-    const double shl = deepspace_consts_.xh2 * f2
-        + deepspace_consts_.xh3 * f3;
+    const double sel = deepspace_->consts.ee2 * f2
+        + deepspace_->consts.e3 * f3;
+    const double sil = deepspace_->consts.xi2 * f2
+        + deepspace_->consts.xi3 * f3;
+    const double sll = deepspace_->consts.xl2 * f2
+        + deepspace_->consts.xl3 * f3
+        + deepspace_->consts.xl4 * sinzf;
+    const double sghl = deepspace_->consts.xgh2 * f2
+        + deepspace_->consts.xgh3 * f3
+        + deepspace_->consts.xgh4 * sinzf;
+    const double shl = deepspace_->consts.xh2 * f2
+        + deepspace_->consts.xh3 * f3;
 
     /*
      * merge calculated values
@@ -1270,6 +1583,7 @@ void SGP4::DeepSpacePeriodics(
  * @param[in,out] em
  * @param[in,out] xinc
  * @param[in,out] xn
+ * @param[in,out] params the integrator state
  */
 void SGP4::DeepSpaceSecular(
         const double tsince,
@@ -1278,60 +1592,65 @@ void SGP4::DeepSpaceSecular(
         double& xnodes,
         double& em,
         double& xinc,
-        double& xn) const
+        double& xn,
+        IntegratorParams& params) const
 {
-    static const double STEP = 720.0;
-    static const double STEP2 = 259200.0;
+    xll += deepspace_->consts.ssl * tsince;
+    omgasm += deepspace_->consts.ssg * tsince;
+    xnodes += deepspace_->consts.ssh * tsince;
+    em += deepspace_->consts.sse * tsince;
+    xinc += deepspace_->consts.ssi * tsince;
 
-    xll += deepspace_consts_.ssl * tsince;
-    omgasm += deepspace_consts_.ssg * tsince;
-    xnodes += deepspace_consts_.ssh * tsince;
-    em += deepspace_consts_.sse * tsince;
-    xinc += deepspace_consts_.ssi * tsince;
-
-    if (deepspace_consts_.resonance_flag)
+    if (deepspace_->consts.resonance_flag)
     {
         /*
          * 1st condition (if tsince is less than one time step from epoch)
-         * 2nd condition (if integrator_params_.atime and
+         * 2nd condition (if params.atime and
          *     tsince are of opposite signs, so zero crossing required)
          * 3rd condition (if tsince is closer to zero than 
-         *     integrator_params_.atime, only integrate away from zero)
+         *     params.atime, only integrate away from zero)
          */
-        if (fabs(tsince) < STEP ||
-                tsince * integrator_params_.atime <= 0.0 ||
-                fabs(tsince) < fabs(integrator_params_.atime))
-        {
-            /*
-             * restart from epoch
-             */
-            integrator_params_.atime = 0.0;
-            integrator_params_.xni = elements_.RecoveredMeanMotion();
-            integrator_params_.xli = integrator_consts_.xlamo;
+        const bool restart = fabs(tsince) < kIntegratorStep ||
+                tsince * params.atime <= 0.0 ||
+                fabs(tsince) < fabs(params.atime);
 
+        /*
+         * the checkpoint nearest to tsince, on the epoch side of it. the
+         * integrator takes the same steps from epoch, so resuming from it
+         * gives the same result as restarting
+         */
+        const size_t steps = std::min(
+                static_cast<size_t>(fabs(tsince) / kIntegratorStep),
+                static_cast<size_t>(kIntegratorCheckpoints));
+        const IntegratorParams& checkpoint = tsince >= 0.0
+            ? deepspace_->forward[steps]
+            : deepspace_->backward[steps];
+
+        if (restart || fabs(checkpoint.atime) > fabs(params.atime))
+        {
             /*
-             * restore precomputed values for epoch
+             * resume from the checkpoint
              */
-            integrator_params_.values_t = integrator_consts_.values_0;
+            params = checkpoint;
         }
 
-        double ft = tsince - integrator_params_.atime;
+        double ft = tsince - params.atime;
 
         /*
          * if time difference (ft) is greater than the time step (720.0)
-         * loop around until integrator_params_.atime is within one time step of
+         * loop around until params.atime is within one time step of
          * tsince
          */
-        if (fabs(ft) >= STEP)
+        if (fabs(ft) >= kIntegratorStep)
         {
             /*
-             * calculate step direction to allow integrator_params_.atime
+             * calculate step direction to allow params.atime
              * to catch up with tsince
              */
-            double delt = -STEP;
+            double delt = -kIntegratorStep;
             if (ft >= 0.0)
             {
-                delt = STEP;
+                delt = kIntegratorStep;
             }
 
             do
@@ -1339,29 +1658,29 @@ void SGP4::DeepSpaceSecular(
                 /*
                  * integrate using current dot terms
                  */
-                DeepSpaceIntegrator(delt, STEP2, integrator_params_.values_t);
+                DeepSpaceIntegrator(delt, kIntegratorStep2, params.values_t, params);
 
                 /*
                  * calculate dot terms for next integration
                  */
-                DeepSpaceCalcDotTerms(integrator_params_.values_t);
+                DeepSpaceCalcDotTerms(params, params.values_t);
 
-                ft = tsince - integrator_params_.atime;
-            } while (fabs(ft) >= STEP);
+                ft = tsince - params.atime;
+            } while (fabs(ft) >= kIntegratorStep);
         }
 
         /*
          * integrator
          */
-        xn = integrator_params_.xni 
-            + integrator_params_.values_t.xndot * ft
-            + integrator_params_.values_t.xnddt * ft * ft * 0.5;
-        const double xl = integrator_params_.xli
-            + integrator_params_.values_t.xldot * ft
-            + integrator_params_.values_t.xndot * ft * ft * 0.5;
-        const double temp = -xnodes + deepspace_consts_.gsto + tsince * kTHDT;
-
-        if (deepspace_consts_.synchronous_flag)
+        xn = params.xni 
+            + params.values_t.xndot * ft
+            + params.values_t.xnddt * ft * ft * 0.5;
+        const double xl = params.xli
+            + params.values_t.xldot * ft
+            + params.values_t.xndot * ft * ft * 0.5;
+        const double temp = -xnodes + deepspace_->consts.gsto + tsince * kTHDT;
+
+        if (deepspace_->consts.synchronous_flag)
         {
             xll = xl + temp - omgasm;
         }
@@ -1374,9 +1693,12 @@ void SGP4::DeepSpaceSecular(
 
 /*
  * Calculate dot terms
+ * @param[in] params the integrator state
  * @param[in,out] the integrator values
  */
-void SGP4::DeepSpaceCalcDotTerms(struct IntegratorValues& values) const
+void SGP4::DeepSpaceCalcDotTerms(
+        const struct IntegratorParams& params,
+        struct IntegratorValues& values) const
 {
     static const double G22 = 5.7686396;
     static const double G32 = 0.95240898;
@@ -1387,71 +1709,71 @@ void SGP4::DeepSpaceCalcDotTerms(struct IntegratorValues& values) const
     static const double FASX4 = 2.8843198;
     static const double FASX6 = 0.37448087;
 
-    if (deepspace_consts_.synchronous_flag)
+    if (deepspace_->consts.synchronous_flag)
     {
 
-        values.xndot = deepspace_consts_.del1
-            * sin(integrator_params_.xli - FASX2)
-            + deepspace_consts_.del2
-            * sin(2.0 * (integrator_params_.xli - FASX4))
-            + deepspace_consts_.del3
-            * sin(3.0 * (integrator_params_.xli - FASX6));
-        values.xnddt = deepspace_consts_.del1
-            * cos(integrator_params_.xli - FASX2)
-            + 2.0 * deepspace_consts_.del2
-            * cos(2.0 * (integrator_params_.xli - FASX4))
-            + 3.0 * deepspace_consts_.del3
-            * cos(3.0 * (integrator_params_.xli - FASX6));
+        values.xndot = deepspace_->consts.del1
+            * sin(params.xli - FASX2)
+            + deepspace_->consts.del2
+            * sin(2.0 * (params.xli - FASX4))
+            + deepspace_->consts.del3
+            * sin(3.0 * (params.xli - FASX6));
+        values.xnddt = deepspace_->consts.del1
+            * cos(params.xli - FASX2)
+            + 2.0 * deepspace_->consts.del2
+            * cos(2.0 * (params.xli - FASX4))
+            + 3.0 * deepspace_->consts.del3
+            * cos(3.0 * (params.xli - FASX6));
     }
     else
     {
         const double xomi = elements_.ArgumentPerigee()
-            + common_consts_.omgdot * integrator_params_.atime;
+            + lane_.omgdot * params.atime;
         const double x2omi = xomi + xomi;
-        const double x2li = integrator_params_.xli + integrator_params_.xli;
-
-        values.xndot = deepspace_consts_.d2201
-            * sin(x2omi + integrator_params_.xli - G22)
-            * + deepspace_consts_.d2211
-            * sin(integrator_params_.xli - G22)
-            + deepspace_consts_.d3210
-            * sin(xomi + integrator_params_.xli - G32)
-            + deepspace_consts_.d3222
-            * sin(-xomi + integrator_params_.xli - G32)
-            + deepspace_consts_.d4410
+        const double x2li = params.xli + params.xli;
+
+        values.xndot = deepspace_->consts.d2201
+            * sin(x2omi + params.xli - G22)
+            * + deepspace_->consts.d2211
+            * sin(params.xli - G22)
+            + deepspace_->consts.d3210
+            * sin(xomi + params.xli - G32)
+            + deepspace_->consts.d3222
+            * sin(-xomi + params.xli - G32)
+            + deepspace_->consts.d4410
             * sin(x2omi + x2li - G44)
-            + deepspace_consts_.d4422
+            + deepspace_->consts.d4422
             * sin(x2li - G44)
-            + deepspace_consts_.d5220
-            * sin(xomi + integrator_params_.xli - G52)
-            + deepspace_consts_.d5232
-            * sin(-xomi + integrator_params_.xli - G52)
-            + deepspace_consts_.d5421
+            + deepspace_->consts.d5220
+            * sin(xomi + params.xli - G52)
+            + deepspace_->consts.d5232
+            * sin(-xomi + params.xli - G52)
+            + deepspace_->consts.d5421
             * sin(xomi + x2li - G54)
-            + deepspace_consts_.d5433
+            + deepspace_->consts.d5433
             * sin(-xomi + x2li - G54);
-        values.xnddt = deepspace_consts_.d2201
-            * cos(x2omi + integrator_params_.xli - G22)
-            + deepspace_consts_.d2211
-            * cos(integrator_params_.xli - G22)
-            + deepspace_consts_.d3210
-            * cos(xomi + integrator_params_.xli - G32)
-            + deepspace_consts_.d3222
-            * cos(-xomi + integrator_params_.xli - G32)
-            + deepspace_consts_.d5220
-            * cos(xomi + integrator_params_.xli - G52)
-            + deepspace_consts_.d5232
-            * cos(-xomi + integrator_params_.xli - G52)
-            + 2.0 * (deepspace_consts_.d4410 * cos(x2omi + x2li - G44)
-            + deepspace_consts_.d4422
+        values.xnddt = deepspace_->consts.d2201
+            * cos(x2omi + params.xli - G22)
+            + deepspace_->consts.d2211
+            * cos(params.xli - G22)
+            + deepspace_->consts.d3210
+            * cos(xomi + params.xli - G32)
+            + deepspace_->consts.d3222
+            * cos(-xomi + params.xli - G32)
+            + deepspace_->consts.d5220
+            * cos(xomi + params.xli - G52)
+            + deepspace_->consts.d5232
+            * cos(-xomi + params.xli - G52)
+            + 2.0 * (deepspace_->consts.d4410 * cos(x2omi + x2li - G44)
+            + deepspace_->consts.d4422
             * cos(x2li - G44)
-            + deepspace_consts_.d5421
+            + deepspace_->consts.d5421
             * cos(xomi + x2li - G54)
-            + deepspace_consts_.d5433
+            + deepspace_->consts.d5433
             * cos(-xomi + x2li - G54));
     }
 
-    values.xldot = integrator_params_.xni + integrator_consts_.xfact;
+    values.xldot = params.xni + deepspace_->integrator.xfact;
     values.xnddt *= values.xldot;
 }
 
@@ -1460,32 +1782,33 @@ void SGP4::DeepSpaceCalcDotTerms(struct IntegratorValues& values) const
  * @param[in] delt
  * @param[in] step2
  * @param[in] values
+ * @param[in,out] params the integrator state
  */
 void SGP4::DeepSpaceIntegrator(
         const double delt,
         const double step2,
-        const struct IntegratorValues &values) const
+        const struct IntegratorValues &values,
+        struct IntegratorParams& params) const
 {
     /*
      * integrator
      */
-    integrator_params_.xli += values.xldot * delt + values.xndot * step2;
-    integrator_params_.xni += values.xndot * delt + values.xnddt * step2;
+    params.xli += values.xldot * delt + values.xndot * step2;
+    params.xni += values.xndot * delt + values.xnddt * step2;
 
     /*
      * increment integrator time
      */
-    integrator_params_.atime += delt;
+    params.atime += delt;
 }
 
-void SGP4::Reset()
+void SGP4::Reset() const
 {
     use_simple_model_ = false;
     use_deep_space_ = false;
+    propagator_ = &SGP4::FindPositionSGP4<false>;
+    elements_status_ = SGP4Kernel::STATUS_OK;
 
-    common_consts_     = Empty_CommonConstants;
-    nearspace_consts_  = Empty_NearSpaceConstants;
-    deepspace_consts_  = Empty_DeepSpaceConstants;
-    integrator_consts_ = Empty_IntegratorConstants;
-    integrator_params_ = Empty_IntegratorParams;
+    lane_ = Empty_NearSpaceLane;
+    deepspace_.Reset(NULL);
 }
@@ -19,10 +19,17 @@
 #define SGP4_H_
 
 #include "Tle.h"
+#include "Omm.h"
 #include "OrbitalElements.h"
 #include "Eci.h"
 #include "SatelliteException.h"
 #include "DecayedException.h"
+#include "SGP4Kernel.h"
+#include "TimeGrid.h"
+#include "OnceFlag.h"
+#include "Propagator.h"
+
+#include <vector>
 
 /**
  * @mainpage
@@ -33,24 +40,264 @@
 /**
  * @brief The simplified perturbations model 4 propagater.
  */
-class SGP4
+class SGP4 : public Propagator
 {
 public:
-    SGP4(const Tle& tle)
+    /**
+     * @brief When the constants of the model are computed.
+     */
+    enum Initialisation
+    {
+        /*
+         * at construction
+         */
+        INITIALISE_NOW,
+        /*
+         * on the first propagation, or by WarmUp()
+         */
+        INITIALISE_LAZY
+    };
+
+    /**
+     * @param[in] tle the element set
+     * @param[in] init when to compute the constants. A lazy satellite
+     * throws on its first propagation any error a construction would
+     */
+    SGP4(const Tle& tle, const Initialisation init = INITIALISE_NOW)
         : elements_(tle)
     {
-        Initialise();
+        Start(init);
+    }
+
+    /**
+     * @param[in] omm the element set, read from an orbit mean-elements
+     * message
+     * @param[in] init when to compute the constants. A lazy satellite
+     * throws on its first propagation any error a construction would
+     */
+    SGP4(const Omm& omm, const Initialisation init = INITIALISE_NOW)
+        : elements_(omm)
+    {
+        Start(init);
     }
 
     virtual ~SGP4()
     {
     }
 
-    void SetTle(const Tle& tle);
+    /**
+     * @brief Deep space resonance integrator values.
+     */
+    struct IntegratorValues
+    {
+        double xndot;
+        double xnddt;
+        double xldot;
+    };
+
+    /**
+     * @brief Deep space resonance integrator state.
+     *
+     * The integrator of resonant (12 hour and 24 hour) deep space orbits
+     * steps from the last time it reached. Pass the same state to
+     * successive FindPosition() calls to continue from there instead of
+     * from epoch. A state belongs to one satellite and one thread.
+     */
+    struct IntegratorParams
+    {
+        /*
+         * integrator values
+         */
+        double xli;
+        double xni;
+        double atime;
+        /*
+         * itegrator values for current d_atime_
+         */
+        struct IntegratorValues values_t;
+    };
+
+    /**
+     * @brief The last solution of keplers equation.
+     *
+     * Stepping forward in small increments, the eccentric anomaly moves
+     * little between calls, so the last solution is a close starting guess
+     * for the next. Used by PropagationCursor.
+     */
+    struct KeplerState
+    {
+        /*
+         * whether the values below are from a converged solve
+         */
+        bool valid;
+        double capu;
+        double epw;
+        double ecose;
+    };
+
+    /**
+     * Replace the element set. Not safe while other threads use the object
+     * @param[in] tle the element set
+     * @param[in] init when to compute the constants
+     */
+    void SetTle(const Tle& tle, const Initialisation init = INITIALISE_NOW);
+
+    /**
+     * @returns whether the constants have been computed
+     */
+    bool IsInitialised() const
+    {
+        return initialised_.Done();
+    }
+
+    /**
+     * Compute the constants of a lazy satellite now, if not yet done.
+     * Safe to call from many threads at once
+     */
+    void EnsureInitialised() const
+    {
+        if (!initialised_.Done())
+        {
+            initialised_.Call(*this, &SGP4::Initialise);
+        }
+    }
+
+    /**
+     * Compute the constants of many lazy satellites, in parallel. A
+     * satellite whose element set is invalid reports it on its first
+     * propagation as usual
+     * @param[in] satellites the satellites, which may already be initialised
+     * @param[in] threads the number of threads, 0 for one per processor
+     */
+    static void WarmUp(
+            const std::vector<SGP4*>& satellites,
+            const unsigned int threads = 0);
+
+    /**
+     * Propagate the satellite. This does not modify the object, apart
+     * from initialising a lazy one once, so one SGP4 can be shared by
+     * many threads.
+     * @param[in] tsince minutes since epoch
+     * @returns the position
+     */
     Eci FindPosition(double tsince) const;
     Eci FindPosition(const DateTime& date) const;
 
+    /**
+     * Propagate the satellite, keeping the deep space integrator state in
+     * params between calls
+     * @param[in] tsince minutes since epoch
+     * @param[in,out] params the integrator state, initially
+     * SGP4::IntegratorParams()
+     * @returns the position
+     */
+    Eci FindPosition(double tsince, IntegratorParams& params) const;
+    Eci FindPosition(const DateTime& date, IntegratorParams& params) const;
+
+    /**
+     * Propagate the satellite without throwing. Decayed and invalid
+     * satellites are reported through the returned status instead of
+     * DecayedException and SatelliteException, which is what
+     * FindPosition() throws for the same status
+     * @param[in] tsince minutes since epoch
+     * @param[out] eci the position, set when the status is STATUS_OK or
+     * STATUS_DECAYED and left unchanged otherwise
+     * @returns the status
+     */
+    SGP4Kernel::Status TryFindPosition(double tsince, Eci& eci) const;
+    SGP4Kernel::Status TryFindPosition(const DateTime& date, Eci& eci) const;
+
+    /**
+     * Propagate the satellite without throwing, keeping the deep space
+     * integrator state in params between calls
+     * @param[in] tsince minutes since epoch
+     * @param[in,out] params the integrator state
+     * @param[out] eci the position, as above
+     * @returns the status
+     */
+    SGP4Kernel::Status TryFindPosition(
+            double tsince,
+            IntegratorParams& params,
+            Eci& eci) const;
+
+    /**
+     * Propagate the satellite to many times at once. Near space orbits are
+     * propagated in blocks of times, one stage at a time, every lane of a
+     * block reading the constants of this satellite. With PRECISION_FAST
+     * and PRECISION_VISUAL the stages vectorise (see SGP4Batch); built
+     * with -O3 -mavx2 -fno-trapping-math -fno-math-errno they take about
+     * a fifth and a ninth of the time per point of calling FindPosition()
+     * in a loop. PRECISION_EXACT runs a lane at a time, at about the cost
+     * of that loop, and its results match FindPosition() for each time;
+     * the same exceptions are thrown for the first time that fails. Deep
+     * space orbits are always exact.
+     * @param[in] tsince minutes since epoch for each position
+     * @param[out] positions the positions, one per time
+     * @param[in] precision the precision tier
+     */
+    void FindPositions(
+            const std::vector<double>& tsince,
+            std::vector<Eci>& positions,
+            const SGP4Kernel::Precision precision
+                = SGP4Kernel::PRECISION_EXACT) const;
+
+    /**
+     * Propagate the satellite to many times at once
+     * @param[in] dates the times to propagate to
+     * @param[out] positions the positions, one per date
+     * @param[in] precision the precision tier
+     */
+    void FindPositions(
+            const std::vector<DateTime>& dates,
+            std::vector<Eci>& positions,
+            const SGP4Kernel::Precision precision
+                = SGP4Kernel::PRECISION_EXACT) const;
+
+    /**
+     * Propagate the satellite to every time of a grid
+     * @param[in] grid the times to propagate to
+     * @param[out] positions the positions, one per time
+     * @param[in] precision the precision tier
+     */
+    void FindPositions(
+            const TimeGrid& grid,
+            std::vector<Eci>& positions,
+            const SGP4Kernel::Precision precision
+                = SGP4Kernel::PRECISION_EXACT) const;
+
 private:
+    friend class SGP4Batch;
+    friend class ChebyshevEphemeris;
+    friend class PropagationCursor;
+    friend class Catalog;
+
+    /*
+     * for Catalog, which restores the constants from an image
+     */
+    explicit SGP4(const OrbitalElements& elements)
+        : elements_(elements)
+    {
+        Reset();
+    }
+
+    void Start(const Initialisation init)
+    {
+        if (init == INITIALISE_NOW)
+        {
+            Initialise();
+            initialised_.SetDone(true);
+
+            if (elements_status_ != SGP4Kernel::STATUS_OK)
+            {
+                ThrowStatus(elements_status_, 0.0, NULL, NULL);
+            }
+        }
+        else
+        {
+            Reset();
+        }
+    }
+
     struct CommonConstants
     {
         double cosio;
@@ -156,13 +403,6 @@ private:
         double del3;
     };
 
-    struct IntegratorValues
-    {
-        double xndot;
-        double xnddt;
-        double xldot;
-    };
-
     struct IntegratorConstants
     {
         /*
@@ -177,25 +417,116 @@ private:
         struct IntegratorValues values_0;
     };
 
-    struct IntegratorParams
+    /*
+     * everything only deep space orbits use, allocated separately so near
+     * space satellites do not carry it
+     */
+    struct DeepSpaceData
     {
+        DeepSpaceData()
+            : consts(Empty_DeepSpaceConstants),
+            integrator(Empty_IntegratorConstants),
+            a3ovk2(0.0)
+        {
+        }
+
+        struct DeepSpaceConstants consts;
+        struct IntegratorConstants integrator;
+        double a3ovk2;
         /*
-         * integrator values
+         * integrator states every step after and before epoch, the first
+         * being epoch. only filled for resonant orbits
          */
-        double xli;
-        double xni;
-        double atime;
-        /*
-         * itegrator values for current d_atime_
-         */
-        struct IntegratorValues values_t;
+        std::vector<struct IntegratorParams> forward;
+        std::vector<struct IntegratorParams> backward;
+    };
+
+    /*
+     * owns the deep space data, copied along with the SGP4
+     */
+    class DeepSpacePtr
+    {
+    public:
+        DeepSpacePtr()
+            : data_(NULL)
+        {
+        }
+
+        DeepSpacePtr(const DeepSpacePtr& other)
+            : data_(other.data_ == NULL
+                    ? NULL : new DeepSpaceData(*other.data_))
+        {
+        }
+
+        ~DeepSpacePtr()
+        {
+            delete data_;
+        }
+
+        DeepSpacePtr& operator=(const DeepSpacePtr& other)
+        {
+            if (this != &other)
+            {
+                Reset(other.data_ == NULL
+                        ? NULL : new DeepSpaceData(*other.data_));
+            }
+            return *this;
+        }
+
+        void Reset(DeepSpaceData* data)
+        {
+            delete data_;
+            data_ = data;
+        }
+
+        DeepSpaceData* operator->()
+        {
+            return data_;
+        }
+
+        const DeepSpaceData* operator->() const
+        {
+            return data_;
+        }
+
+    private:
+        DeepSpaceData* data_;
     };
-    
-    void Initialise();
-    Eci FindPositionSDP4(const double tsince) const;
-    Eci FindPositionSGP4(double tsince) const;
-    Eci CalculateFinalPositionVelocity(
+
+    void Initialise() const;
+    void ChoosePropagator() const;
+    SGP4Kernel::Status Propagate(
+            const double tsince,
+            IntegratorParams& params,
+            KeplerState* kepler,
+            double* position,
+            double* velocity) const;
+    Eci MakeEci(
             const double tsince,
+            const double* position,
+            const double* velocity) const;
+    SGP4Kernel::Status FindPositionSDP4(
+            const double tsince,
+            struct IntegratorParams& params,
+            KeplerState* kepler,
+            double* position,
+            double* velocity) const;
+    template <bool Simple>
+    SGP4Kernel::Status FindPositionSGP4(
+            double tsince,
+            IntegratorParams& params,
+            KeplerState* kepler,
+            double* position,
+            double* velocity) const;
+    void MakeNearSpaceLane(
+            const CommonConstants& common,
+            const NearSpaceConstants& nearspace) const;
+    void ThrowStatus(
+            const int status,
+            const double tsince,
+            const double* position,
+            const double* velocity) const;
+    SGP4Kernel::Status CalculateFinalPositionVelocity(
             const double e,
             const double a,
             const double omega,
@@ -208,7 +539,10 @@ private:
             const double x1mth2,
             const double x7thm1,
             const double cosio,
-            const double sinio) const;
+            const double sinio,
+            KeplerState* kepler,
+            double* position,
+            double* velocity) const;
     void DeepSpaceInitialise(
             const double eosq,
             const double sinio,
@@ -218,7 +552,7 @@ private:
             const double betao2,
             const double xmdot,
             const double omgdot,
-            const double xnodot);
+            const double xnodot) const;
     void DeepSpaceCalculateLunarSolarTerms(
             const double tsince,
             double& pe,
@@ -240,39 +574,71 @@ private:
             double& xnodes,
             double& em,
             double& xinc,
-            double& xn) const;
-    void DeepSpaceCalcDotTerms(struct IntegratorValues& values) const;
+            double& xn,
+            struct IntegratorParams& params) const;
+    void DeepSpaceCalcDotTerms(
+            const struct IntegratorParams& params,
+            struct IntegratorValues& values) const;
     void DeepSpaceIntegrator(
             const double delt,
             const double step2,
-            const struct IntegratorValues& values) const;
-    void Reset();
+            const struct IntegratorValues& values,
+            struct IntegratorParams& params) const;
+    void Reset() const;
+
+    /*
+     * everything from here to elements_ is computed by Initialise(),
+     * which a lazy satellite runs from its const propagation methods, so
+     * it is mutable. it is written only under initialised_
+     */
+
+    /*
+     * the constants every propagation reads, together at the front of
+     * the object. the fields the simple model uses come first
+     */
+    mutable SGP4Kernel::NearSpaceLane lane_;
+
+    /*
+     * the function of the model, chosen once by Initialise()
+     */
+    typedef SGP4Kernel::Status (SGP4::*ModelFunction)(
+            double tsince,
+            IntegratorParams& params,
+            KeplerState* kepler,
+            double* position,
+            double* velocity) const;
+    mutable ModelFunction propagator_;
 
     /*
      * flags
      */
-    bool use_simple_model_;
-    bool use_deep_space_;
+    mutable bool use_simple_model_;
+    mutable bool use_deep_space_;
+
+    /*
+     * deep space constants and integrator, NULL for near space orbits
+     */
+    mutable DeepSpacePtr deepspace_;
 
     /*
-     * the constants used
+     * whether the constants above have been computed, and whether the
+     * element set passed the checks of Initialise()
      */
-    struct CommonConstants common_consts_;
-    struct NearSpaceConstants nearspace_consts_;
-    struct DeepSpaceConstants deepspace_consts_;
-    struct IntegratorConstants integrator_consts_;
-    mutable struct IntegratorParams integrator_params_;
+    mutable OnceFlag initialised_;
+    mutable SGP4Kernel::Status elements_status_;
 
     /*
      * the orbit data
      */
     OrbitalElements elements_;
 
+    static const SGP4Kernel::NearSpaceLane Empty_NearSpaceLane;
     static const struct SGP4::CommonConstants Empty_CommonConstants;
     static const struct SGP4::NearSpaceConstants Empty_NearSpaceConstants;
     static const struct SGP4::DeepSpaceConstants Empty_DeepSpaceConstants;
     static const struct SGP4::IntegratorConstants Empty_IntegratorConstants;
     static const struct SGP4::IntegratorParams Empty_IntegratorParams;
+    static const struct SGP4::KeplerState Empty_KeplerState;
 };
 
 #endif
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SGP4Batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void SGP4Batch::Add(const SGP4& sgp4)
+{
+    sgp4.EnsureInitialised();
+
+    if (sgp4.use_deep_space_
+            || sgp4.elements_status_ != SGP4Kernel::STATUS_OK)
+    {
+        deepspace_.push_back(sgp4);
+        deepspace_index_.push_back(size_);
+    }
+    else
+    {
+        NearSpaceGroup& group = sgp4.use_simple_model_
+            ? nearspace_simple_
+            : nearspace_;
+
+        group.columns.Append(sgp4.lane_);
+        group.epoch.push_back(sgp4.elements_.Epoch().Ticks());
+        group.index.push_back(size_);
+    }
+
+    size_++;
+}
+
+void SGP4Batch::Clear()
+{
+    size_ = 0;
+
+    nearspace_.Clear();
+    nearspace_simple_.Clear();
+
+    deepspace_.clear();
+    deepspace_index_.clear();
+}
+
+void SGP4Batch::FindPositions(
+        const DateTime& dt,
+        double* position,
+        double* velocity,
+        const SGP4Kernel::Precision precision) const
+{
+    FindPositions(dt, position, velocity, NULL, precision);
+}
+
+void SGP4Batch::FindPositions(
+        const DateTime& dt,
+        double* position,
+        double* velocity,
+        SGP4Kernel::Status* status,
+        const SGP4Kernel::Precision precision) const
+{
+    for (size_t begin = 0;
+            begin < nearspace_.index.size();
+            begin += SGP4Kernel::kBlockSize)
+    {
+        const size_t count = std::min(SGP4Kernel::kBlockSize,
+                nearspace_.index.size() - begin);
+
+        PropagateNearSpace<false>(nearspace_, dt, begin, count,
+                position, velocity, status, precision);
+    }
+
+    for (size_t begin = 0;
+            begin < nearspace_simple_.index.size();
+            begin += SGP4Kernel::kBlockSize)
+    {
+        const size_t count = std::min(SGP4Kernel::kBlockSize,
+                nearspace_simple_.index.size() - begin);
+
+        PropagateNearSpace<true>(nearspace_simple_, dt, begin, count,
+                position, velocity, status, precision);
+    }
+
+    static const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    for (size_t i = 0; i < deepspace_.size(); i++)
+    {
+        const SGP4& sgp4 = deepspace_[i];
+        double* pos = position + 3 * deepspace_index_[i];
+        double* vel = velocity + 3 * deepspace_index_[i];
+
+        SGP4::IntegratorParams params = SGP4::Empty_IntegratorParams;
+        const SGP4Kernel::Status result = sgp4.Propagate(
+                (dt - sgp4.elements_.Epoch()).TotalMinutes(),
+                params, NULL, pos, vel);
+
+        if (result != SGP4Kernel::STATUS_OK)
+        {
+            std::fill(pos, pos + 3, nan);
+            std::fill(vel, vel + 3, nan);
+        }
+
+        if (status != NULL)
+        {
+            status[deepspace_index_[i]] = result;
+        }
+    }
+}
+
+/**
+ * Propagate one block of near space lanes of one model
+ * @param[in] group the satellites of the model
+ * @param[in] dt the time to propagate to
+ * @param[in] begin the first lane of the block
+ * @param[in] count the number of lanes in the block (<= kBlockSize)
+ * @param[out] position
+ * @param[out] velocity
+ * @param[out] status the status of each satellite, or NULL
+ * @param[in] precision the precision tier
+ */
+template <bool Simple>
+void SGP4Batch::PropagateNearSpace(
+        const NearSpaceGroup& group,
+        const DateTime& dt,
+        const size_t begin,
+        const size_t count,
+        double* position,
+        double* velocity,
+        SGP4Kernel::Status* status,
+        const SGP4Kernel::Precision precision) const
+{
+    double tsince[SGP4Kernel::kBlockSize];
+    double pos[3 * SGP4Kernel::kBlockSize];
+    double vel[3 * SGP4Kernel::kBlockSize];
+    int lane_status[SGP4Kernel::kBlockSize];
+
+    const long long ticks = dt.Ticks();
+
+    for (size_t j = 0; j < count; j++)
+    {
+        tsince[j] = static_cast<double>(ticks - group.epoch[begin + j])
+            / TicksPerMinute;
+    }
+
+    switch (precision)
+    {
+    case SGP4Kernel::PRECISION_VISUAL:
+        SGP4Kernel::PropagateNearSpaceBlock<SGP4Kernel::VisualTier, Simple,
+                false>(
+                group.columns.Columns(begin),
+                tsince, count, pos, vel, lane_status);
+        break;
+    case SGP4Kernel::PRECISION_FAST:
+        SGP4Kernel::PropagateNearSpaceBlock<SGP4Kernel::FastTier, Simple,
+                false>(
+                group.columns.Columns(begin),
+                tsince, count, pos, vel, lane_status);
+        break;
+    default:
+        SGP4Kernel::PropagateNearSpaceBlock<SGP4Kernel::ExactTier, Simple,
+                false>(
+                group.columns.Columns(begin),
+                tsince, count, pos, vel, lane_status);
+        break;
+    }
+
+    static const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    for (size_t j = 0; j < count; j++)
+    {
+        double* out_pos = position + 3 * group.index[begin + j];
+        double* out_vel = velocity + 3 * group.index[begin + j];
+
+        if (lane_status[j] == SGP4Kernel::STATUS_OK)
+        {
+            std::copy(pos + 3 * j, pos + 3 * j + 3, out_pos);
+            std::copy(vel + 3 * j, vel + 3 * j + 3, out_vel);
+        }
+        else
+        {
+            std::fill(out_pos, out_pos + 3, nan);
+            std::fill(out_vel, out_vel + 3, nan);
+        }
+
+        if (status != NULL)
+        {
+            status[group.index[begin + j]]
+                = static_cast<SGP4Kernel::Status>(lane_status[j]);
+        }
+    }
+}
+
+void SGP4Batch::NearSpaceColumns::Append(const SGP4Kernel::NearSpaceLane& lane)
+{
+    xmo.push_back(lane.xmo);
+    omegao.push_back(lane.omegao);
+    xnodeo.push_back(lane.xnodeo);
+    eo.push_back(lane.eo);
+    xincl.push_back(lane.xincl);
+    bstar.push_back(lane.bstar);
+    aodp.push_back(lane.aodp);
+    xnodp.push_back(lane.xnodp);
+    xmdot.push_back(lane.xmdot);
+    omgdot.push_back(lane.omgdot);
+    xnodot.push_back(lane.xnodot);
+    xnodcf.push_back(lane.xnodcf);
+    c1.push_back(lane.c1);
+    c4.push_back(lane.c4);
+    t2cof.push_back(lane.t2cof);
+    eta.push_back(lane.eta);
+    omgcof.push_back(lane.omgcof);
+    xmcof.push_back(lane.xmcof);
+    delmo.push_back(lane.delmo);
+    sinmo.push_back(lane.sinmo);
+    c5.push_back(lane.c5);
+    d2.push_back(lane.d2);
+    d3.push_back(lane.d3);
+    d4.push_back(lane.d4);
+    t3cof.push_back(lane.t3cof);
+    t4cof.push_back(lane.t4cof);
+    t5cof.push_back(lane.t5cof);
+    xlcof.push_back(lane.xlcof);
+    aycof.push_back(lane.aycof);
+    x3thm1.push_back(lane.x3thm1);
+    x1mth2.push_back(lane.x1mth2);
+    x7thm1.push_back(lane.x7thm1);
+    cosio.push_back(lane.cosio);
+    sinio.push_back(lane.sinio);
+}
+
+SGP4Kernel::LaneColumns SGP4Batch::NearSpaceColumns::Columns(
+        const size_t begin) const
+{
+    SGP4Kernel::LaneColumns columns;
+
+    columns.xmo = &xmo[begin];
+    columns.omegao = &omegao[begin];
+    columns.xnodeo = &xnodeo[begin];
+    columns.eo = &eo[begin];
+    columns.xincl = &xincl[begin];
+    columns.bstar = &bstar[begin];
+    columns.aodp = &aodp[begin];
+    columns.xnodp = &xnodp[begin];
+    columns.xmdot = &xmdot[begin];
+    columns.omgdot = &omgdot[begin];
+    columns.xnodot = &xnodot[begin];
+    columns.xnodcf = &xnodcf[begin];
+    columns.c1 = &c1[begin];
+    columns.c4 = &c4[begin];
+    columns.t2cof = &t2cof[begin];
+    columns.eta = &eta[begin];
+    columns.omgcof = &omgcof[begin];
+    columns.xmcof = &xmcof[begin];
+    columns.delmo = &delmo[begin];
+    columns.sinmo = &sinmo[begin];
+    columns.c5 = &c5[begin];
+    columns.d2 = &d2[begin];
+    columns.d3 = &d3[begin];
+    columns.d4 = &d4[begin];
+    columns.t3cof = &t3cof[begin];
+    columns.t4cof = &t4cof[begin];
+    columns.t5cof = &t5cof[begin];
+    columns.xlcof = &xlcof[begin];
+    columns.aycof = &aycof[begin];
+    columns.x3thm1 = &x3thm1[begin];
+    columns.x1mth2 = &x1mth2[begin];
+    columns.x7thm1 = &x7thm1[begin];
+    columns.cosio = &cosio[begin];
+    columns.sinio = &sinio[begin];
+
+    return columns;
+}
+
+void SGP4Batch::NearSpaceColumns::Clear()
+{
+    *this = NearSpaceColumns();
+}
+
+void SGP4Batch::NearSpaceGroup::Clear()
+{
+    columns.Clear();
+    epoch.clear();
+    index.clear();
+}
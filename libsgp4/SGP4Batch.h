@@ -0,0 +1,196 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SGP4BATCH_H_
+#define SGP4BATCH_H_
+
+#include "SGP4.h"
+#include "DateTime.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Propagates many satellites to the same time.
+ *
+ * The constants of the near space satellites are stored column wise
+ * (structure of arrays) and propagated in blocks, one stage at a time, so
+ * that the secular update, the kepler solve and the short period update
+ * each run as a branch free loop over lanes reading the columns in place.
+ * With PRECISION_FAST and PRECISION_VISUAL these loops vectorise (e.g.
+ * -O3 -mavx2 -fno-trapping-math -fno-math-errno); PRECISION_EXACT calls
+ * the standard library and runs a lane at a time. Satellites are grouped
+ * by model, so every lane of a block runs the same code: the simple and
+ * full near space models each have their own columns and kernel, and deep
+ * space satellites are propagated with the scalar SGP4 path.
+ *
+ * With PRECISION_EXACT positions agree with SGP4::FindPosition to within
+ * 1e-9 km and velocities to within 1e-12 km/s. Any difference comes from
+ * the compiler contracting multiply-adds differently.
+ */
+class SGP4Batch
+{
+public:
+    SGP4Batch()
+        : size_(0)
+    {
+    }
+
+    virtual ~SGP4Batch()
+    {
+    }
+
+    /**
+     * Add a satellite to the batch
+     * @param[in] sgp4 the propagator of the satellite, initialised here if
+     * lazy
+     */
+    void Add(const SGP4& sgp4);
+
+    /**
+     * Remove all satellites
+     */
+    void Clear();
+
+    /**
+     * @returns the number of satellites in the batch
+     */
+    size_t Size() const
+    {
+        return size_;
+    }
+
+    /**
+     * Propagate every satellite to the given time. Satellites are reported
+     * in the order they were added. Satellites that fail to propagate
+     * (decayed, invalid elements) are reported as NaN.
+     * @param[in] dt the time to propagate to
+     * @param[out] position 3 * Size() values, x, y, z in km per satellite
+     * @param[out] velocity 3 * Size() values, x, y, z in km/s per satellite
+     * @param[in] precision the precision tier of the near space satellites
+     */
+    void FindPositions(
+            const DateTime& dt,
+            double* position,
+            double* velocity,
+            const SGP4Kernel::Precision precision
+                = SGP4Kernel::PRECISION_EXACT) const;
+
+    /**
+     * Propagate every satellite to the given time, reporting why each
+     * satellite that failed did so. Never throws for a failed satellite
+     * @param[in] dt the time to propagate to
+     * @param[out] position 3 * Size() values, NaN where the status is not
+     * STATUS_OK
+     * @param[out] velocity 3 * Size() values, as position
+     * @param[out] status Size() values, the status of each satellite
+     * @param[in] precision the precision tier of the near space satellites
+     */
+    void FindPositions(
+            const DateTime& dt,
+            double* position,
+            double* velocity,
+            SGP4Kernel::Status* status,
+            const SGP4Kernel::Precision precision
+                = SGP4Kernel::PRECISION_EXACT) const;
+
+private:
+    /**
+     * @brief Near space constants stored column wise.
+     */
+    struct NearSpaceColumns
+    {
+        void Append(const SGP4Kernel::NearSpaceLane& lane);
+        SGP4Kernel::LaneColumns Columns(const size_t begin) const;
+        void Clear();
+
+        std::vector<double> xmo;
+        std::vector<double> omegao;
+        std::vector<double> xnodeo;
+        std::vector<double> eo;
+        std::vector<double> xincl;
+        std::vector<double> bstar;
+        std::vector<double> aodp;
+        std::vector<double> xnodp;
+        std::vector<double> xmdot;
+        std::vector<double> omgdot;
+        std::vector<double> xnodot;
+        std::vector<double> xnodcf;
+        std::vector<double> c1;
+        std::vector<double> c4;
+        std::vector<double> t2cof;
+        std::vector<double> eta;
+        std::vector<double> omgcof;
+        std::vector<double> xmcof;
+        std::vector<double> delmo;
+        std::vector<double> sinmo;
+        std::vector<double> c5;
+        std::vector<double> d2;
+        std::vector<double> d3;
+        std::vector<double> d4;
+        std::vector<double> t3cof;
+        std::vector<double> t4cof;
+        std::vector<double> t5cof;
+        std::vector<double> xlcof;
+        std::vector<double> aycof;
+        std::vector<double> x3thm1;
+        std::vector<double> x1mth2;
+        std::vector<double> x7thm1;
+        std::vector<double> cosio;
+        std::vector<double> sinio;
+    };
+
+    /**
+     * @brief The near space satellites of one model.
+     */
+    struct NearSpaceGroup
+    {
+        void Clear();
+
+        NearSpaceColumns columns;
+        std::vector<long long> epoch;
+        std::vector<size_t> index;
+    };
+
+    template <bool Simple>
+    void PropagateNearSpace(
+            const NearSpaceGroup& group,
+            const DateTime& dt,
+            const size_t begin,
+            const size_t count,
+            double* position,
+            double* velocity,
+            SGP4Kernel::Status* status,
+            const SGP4Kernel::Precision precision) const;
+
+    size_t size_;
+
+    /*
+     * near space satellites, full and simple model
+     */
+    NearSpaceGroup nearspace_;
+    NearSpaceGroup nearspace_simple_;
+
+    /*
+     * deep space satellites, and those with an invalid element set,
+     * propagated one at a time
+     */
+    std::vector<SGP4> deepspace_;
+    std::vector<size_t> deepspace_index_;
+};
+
+#endif
@@ -0,0 +1,938 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SGP4KERNEL_H_
+#define SGP4KERNEL_H_
+
+#include "Globals.h"
+#include "VectorMath.h"
+
+#include <cmath>
+#include <cstddef>
+
+/*
+ * no aliasing between the arrays of a block
+ */
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define SGP4_RESTRICT __restrict
+#else
+#define SGP4_RESTRICT
+#endif
+
+/**
+ * @brief Per-lane building blocks of the near space SGP4 propagation.
+ *
+ * Every function works on a single lane, one satellite at one time, is
+ * branch free and has no side effects, so the scalar propagator can call
+ * them directly and the batch propagators can call them from inside loops
+ * over lanes that the compiler is able to vectorise. Errors are reported
+ * through the returned status instead of exceptions.
+ */
+namespace SGP4Kernel
+{
+    /*
+     * propagation status, of a lane or of SGP4::TryFindPosition()
+     */
+    enum Status
+    {
+        STATUS_OK = 0,
+        STATUS_ECCENTRICITY,
+        STATUS_ELSQ,
+        STATUS_PL,
+        STATUS_DECAYED,
+        /*
+         * deep space mean motion fell to zero
+         */
+        STATUS_MEAN_MOTION,
+        /*
+         * element set rejected at initialisation
+         */
+        STATUS_ECCENTRICITY_RANGE,
+        STATUS_INCLINATION_RANGE
+    };
+
+    /*
+     * number of Newton-Raphson iterations allowed in the kepler solve
+     */
+    static const int kKeplerIterations = 10;
+
+    /*
+     * convergence tolerance of the kepler solve
+     */
+    static const double kKeplerTolerance = 1.0e-12;
+
+    /*
+     * number of lanes propagated together by PropagateNearSpaceBlock()
+     */
+    static const size_t kBlockSize = 64;
+
+    /**
+     * Precision tiers of the batch propagators. Position errors are the
+     * worst case measured against SGP4::FindPosition() over +-7 days from
+     * epoch for a sample of near space orbits.
+     */
+    enum Precision
+    {
+        /*
+         * double precision, identical to SGP4::FindPosition()
+         */
+        PRECISION_EXACT = 0,
+        /*
+         * double precision with the VectorMath kernels, which vectorise.
+         * worst case error below 1e-6 km
+         */
+        PRECISION_FAST,
+        /*
+         * single precision after the secular update, a relaxed kepler
+         * solve and the float VectorMath kernels. worst case error about
+         * 0.1 km, meant for drawing, not for pass prediction. when the
+         * stages vectorise a vector holds twice as many float lanes, and
+         * it takes about half the time of PRECISION_FAST; when they do
+         * not, only the cheaper scalar math is gained, 15 to 40%
+         */
+        PRECISION_VISUAL
+    };
+
+    /**
+     * @brief The exact tier: double precision and the standard library.
+     *
+     * A tier supplies the number type and math of the stages after the
+     * secular update, the math of the secular update, and the settings of
+     * the kepler solve.
+     */
+    struct ExactTier
+    {
+        typedef double Real;
+
+        /*
+         * the standard library calls keep a loop over lanes from
+         * vectorising
+         */
+        static bool Vectorises()
+        {
+            return false;
+        }
+
+        static int KeplerIterations()
+        {
+            return kKeplerIterations;
+        }
+
+        static double KeplerTolerance()
+        {
+            return kKeplerTolerance;
+        }
+
+        /*
+         * secular update
+         */
+        static double Sin(const double x)
+        {
+            return sin(x);
+        }
+
+        static double Cos(const double x)
+        {
+            return cos(x);
+        }
+
+        static double Cube(const double x)
+        {
+            return pow(x, 3.0);
+        }
+
+        /*
+         * the stages after it
+         */
+        static void SinCos(const double x, double& s, double& c)
+        {
+            s = sin(x);
+            c = cos(x);
+        }
+
+        static double Atan2(const double y, const double x)
+        {
+            return atan2(y, x);
+        }
+
+        static double Sqrt(const double x)
+        {
+            return sqrt(x);
+        }
+
+        static double Fabs(const double x)
+        {
+            return fabs(x);
+        }
+
+        static double Fmod(const double x, const double y)
+        {
+            return fmod(x, y);
+        }
+
+        static double Pow15(const double x)
+        {
+            return pow(x, 1.5);
+        }
+
+        /*
+         * store a secular angle for the remaining stages
+         */
+        static void NarrowAngle(const double x, double& out)
+        {
+            out = x;
+        }
+    };
+
+    /**
+     * @brief The fast tier: double precision with the VectorMath kernels
+     * in place of the standard library calls, which keep a block from
+     * vectorising.
+     */
+    struct FastTier : public ExactTier
+    {
+        static bool Vectorises()
+        {
+            return true;
+        }
+
+        static double Sin(const double x)
+        {
+            double s;
+            double c;
+            VectorMath::SinCos(x, s, c);
+            return s;
+        }
+
+        static double Cos(const double x)
+        {
+            double s;
+            double c;
+            VectorMath::SinCos(x, s, c);
+            return c;
+        }
+
+        static double Cube(const double x)
+        {
+            return x * x * x;
+        }
+
+        static void SinCos(const double x, double& s, double& c)
+        {
+            VectorMath::SinCos(x, s, c);
+        }
+
+        static double Atan2(const double y, const double x)
+        {
+            return VectorMath::Atan2(y, x);
+        }
+
+        static double Fmod(const double x, const double y)
+        {
+            return x - y * VectorMath::Trunc(x / y);
+        }
+
+        static double Pow15(const double x)
+        {
+            return x * sqrt(x);
+        }
+    };
+
+    /**
+     * @brief The visual tier: the secular update of the fast tier, single
+     * precision after it, and a relaxed kepler solve.
+     */
+    struct VisualTier : public FastTier
+    {
+        typedef float Real;
+
+        static int KeplerIterations()
+        {
+            return 5;
+        }
+
+        static float KeplerTolerance()
+        {
+            return 1.0e-5f;
+        }
+
+        static void SinCos(const float x, float& s, float& c)
+        {
+            VectorMath::SinCos(x, s, c);
+        }
+
+        static float Atan2(const float y, const float x)
+        {
+            return VectorMath::Atan2(y, x);
+        }
+
+        static float Sqrt(const float x)
+        {
+            return std::sqrt(x);
+        }
+
+        static float Fabs(const float x)
+        {
+            return std::fabs(x);
+        }
+
+        static float Fmod(const float x, const float y)
+        {
+            return x - y * VectorMath::Trunc(x / y);
+        }
+
+        static float Pow15(const float x)
+        {
+            return x * std::sqrt(x);
+        }
+
+        /*
+         * reduce first, so that little of the float mantissa is lost
+         */
+        static void NarrowAngle(const double x, float& out)
+        {
+            out = static_cast<float>(FastTier::Fmod(x, kTWOPI));
+        }
+    };
+
+    /**
+     * @brief The constants a near space (period < 225 minutes) lane needs.
+     */
+    struct NearSpaceLane
+    {
+        /*
+         * orbital elements
+         */
+        double xmo;
+        double omegao;
+        double xnodeo;
+        double eo;
+        double xincl;
+        double bstar;
+        double aodp;
+        double xnodp;
+        /*
+         * secular rates and drag coefficients
+         */
+        double xmdot;
+        double omgdot;
+        double xnodot;
+        double xnodcf;
+        double c1;
+        double c4;
+        double t2cof;
+        /*
+         * long and short period coefficients
+         */
+        double xlcof;
+        double aycof;
+        double x3thm1;
+        double x1mth2;
+        double x7thm1;
+        double cosio;
+        double sinio;
+        /*
+         * higher order drag terms, unused by the simple model
+         */
+        double eta;
+        double omgcof;
+        double xmcof;
+        double delmo;
+        double sinmo;
+        double c5;
+        double d2;
+        double d3;
+        double d4;
+        double t3cof;
+        double t4cof;
+        double t5cof;
+    };
+
+    /**
+     * @brief The constants of the lanes of a block, one column each.
+     *
+     * Lane j reads element j of every column, so a stage loading one
+     * constant for consecutive lanes loads consecutive doubles. Built
+     * from a NearSpaceLane, every column holds the one satellite, read at
+     * index 0.
+     */
+    struct LaneColumns
+    {
+        LaneColumns()
+        {
+        }
+
+        explicit LaneColumns(const NearSpaceLane& lane)
+            : xmo(&lane.xmo),
+            omegao(&lane.omegao),
+            xnodeo(&lane.xnodeo),
+            eo(&lane.eo),
+            xincl(&lane.xincl),
+            bstar(&lane.bstar),
+            aodp(&lane.aodp),
+            xnodp(&lane.xnodp),
+            xmdot(&lane.xmdot),
+            omgdot(&lane.omgdot),
+            xnodot(&lane.xnodot),
+            xnodcf(&lane.xnodcf),
+            c1(&lane.c1),
+            c4(&lane.c4),
+            t2cof(&lane.t2cof),
+            xlcof(&lane.xlcof),
+            aycof(&lane.aycof),
+            x3thm1(&lane.x3thm1),
+            x1mth2(&lane.x1mth2),
+            x7thm1(&lane.x7thm1),
+            cosio(&lane.cosio),
+            sinio(&lane.sinio),
+            eta(&lane.eta),
+            omgcof(&lane.omgcof),
+            xmcof(&lane.xmcof),
+            delmo(&lane.delmo),
+            sinmo(&lane.sinmo),
+            c5(&lane.c5),
+            d2(&lane.d2),
+            d3(&lane.d3),
+            d4(&lane.d4),
+            t3cof(&lane.t3cof),
+            t4cof(&lane.t4cof),
+            t5cof(&lane.t5cof)
+        {
+        }
+
+        const double* xmo;
+        const double* omegao;
+        const double* xnodeo;
+        const double* eo;
+        const double* xincl;
+        const double* bstar;
+        const double* aodp;
+        const double* xnodp;
+        const double* xmdot;
+        const double* omgdot;
+        const double* xnodot;
+        const double* xnodcf;
+        const double* c1;
+        const double* c4;
+        const double* t2cof;
+        const double* xlcof;
+        const double* aycof;
+        const double* x3thm1;
+        const double* x1mth2;
+        const double* x7thm1;
+        const double* cosio;
+        const double* sinio;
+        const double* eta;
+        const double* omgcof;
+        const double* xmcof;
+        const double* delmo;
+        const double* sinmo;
+        const double* c5;
+        const double* d2;
+        const double* d3;
+        const double* d4;
+        const double* t3cof;
+        const double* t4cof;
+        const double* t5cof;
+    };
+
+    /**
+     * Update for secular gravity and atmospheric drag. Simple selects the
+     * simple (perigee < 220km) model at compile time, which never reads
+     * the higher order drag terms. Branch free, so a loop over lanes
+     * calling it vectorises.
+     * @tparam Tier the precision tier
+     * @param[in] c the constants
+     * @param[in] k the lane of the constants
+     * @param[in] tsince minutes since epoch
+     * @param[out] e eccentricity
+     * @param[out] a semi major axis
+     * @param[out] omega argument of perigee
+     * @param[out] xl mean longitude
+     * @param[out] xnode right ascension of the ascending node
+     * @returns lane status
+     */
+    template <typename Tier, bool Simple>
+    inline int NearSpaceSecular(
+            const LaneColumns& c,
+            const size_t k,
+            const double tsince,
+            double& e,
+            double& a,
+            double& omega,
+            double& xl,
+            double& xnode)
+    {
+        const double xmdf = c.xmo[k] + c.xmdot[k] * tsince;
+        const double omgadf = c.omegao[k] + c.omgdot[k] * tsince;
+        const double xnoddf = c.xnodeo[k] + c.xnodot[k] * tsince;
+
+        const double tsq = tsince * tsince;
+        xnode = xnoddf + c.xnodcf[k] * tsq;
+        double tempa = 1.0 - c.c1[k] * tsince;
+        double tempe = c.bstar[k] * c.c4[k] * tsince;
+        double templ = c.t2cof[k] * tsq;
+
+        omega = omgadf;
+        double xmp = xmdf;
+
+        if (!Simple)
+        {
+            const double delomg = c.omgcof[k] * tsince;
+            const double delm = c.xmcof[k]
+                * (Tier::Cube(1.0 + c.eta[k] * Tier::Cos(xmdf))
+                        * - c.delmo[k]);
+            const double temp = delomg + delm;
+
+            xmp += temp;
+            omega -= temp;
+
+            const double tcube = tsq * tsince;
+            const double tfour = tsince * tcube;
+
+            tempa = tempa - c.d2[k] * tsq - c.d3[k]
+                * tcube - c.d4[k] * tfour;
+            tempe += c.bstar[k] * c.c5[k]
+                * (Tier::Sin(xmp) - c.sinmo[k]);
+            templ += c.t3cof[k] * tcube + tfour
+                * (c.t4cof[k] + tsince * c.t5cof[k]);
+        }
+
+        a = c.aodp[k] * tempa * tempa;
+        e = c.eo[k] - tempe;
+        xl = xmp + omega + xnode + c.xnodp[k] * templ;
+
+        /*
+         * fix tolerance for error recognition
+         */
+        const int status = e <= -0.001 ? STATUS_ECCENTRICITY : STATUS_OK;
+        e = e < 1.0e-6 ? 1.0e-6 : e;
+        e = e > (1.0 - 1.0e-6) ? (1.0 - 1.0e-6) : e;
+
+        return status;
+    }
+
+    /**
+     * Long period periodics, preparing the kepler solve. Branch free
+     * @param[in] e eccentricity
+     * @param[in] a semi major axis
+     * @param[in] omega argument of perigee
+     * @param[in] xl mean longitude
+     * @param[in] xnode right ascension of the ascending node
+     * @param[in] xlcof
+     * @param[in] aycof
+     * @param[out] axn
+     * @param[out] ayn
+     * @param[out] capu the mean anomaly term the kepler solve starts from
+     * @param[out] elsq
+     * @returns lane status
+     */
+    template <typename Tier, typename Real>
+    inline int LongPeriodic(
+            const Real e,
+            const Real a,
+            const Real omega,
+            const Real xl,
+            const Real xnode,
+            const Real xlcof,
+            const Real aycof,
+            Real& axn,
+            Real& ayn,
+            Real& capu,
+            Real& elsq)
+    {
+        Real sin_omega;
+        Real cos_omega;
+        Tier::SinCos(omega, sin_omega, cos_omega);
+
+        const Real beta2 = Real(1.0) - e * e;
+        axn = e * cos_omega;
+        const Real temp11 = Real(1.0) / (a * beta2);
+        const Real xll = temp11 * xlcof * axn;
+        const Real aynl = temp11 * aycof;
+        const Real xlt = xl + xll;
+        ayn = e * sin_omega + aynl;
+        elsq = axn * axn + ayn * ayn;
+
+        /*
+         * The fmod saves reduction of angle to +/-2pi in sin/cos() and
+         * prevents convergence problems.
+         */
+        capu = Tier::Fmod(xlt - xnode, Real(kTWOPI));
+
+        return elsq >= Real(1.0) ? STATUS_ELSQ : STATUS_OK;
+    }
+
+    /**
+     * One Newton-Raphson iteration of the kepler solve. Branch free: a
+     * converged epw is left as it is, and the iteration number is the
+     * same for every lane of a loop
+     * @param[in] i the iteration number
+     * @param[in] capu
+     * @param[in] axn
+     * @param[in] ayn
+     * @param[in] max_newton_raphson sensibility check for the first correction
+     * @param[in,out] epw the eccentric anomaly term
+     * @param[out] sinepw
+     * @param[out] cosepw
+     * @param[out] ecose
+     * @param[out] esine
+     * @returns true once epw has converged
+     */
+    template <typename Tier, typename Real>
+    inline bool KeplerStep(
+            const int i,
+            const Real capu,
+            const Real axn,
+            const Real ayn,
+            const Real max_newton_raphson,
+            Real& epw,
+            Real& sinepw,
+            Real& cosepw,
+            Real& ecose,
+            Real& esine)
+    {
+        Tier::SinCos(epw, sinepw, cosepw);
+        ecose = axn * cosepw + ayn * sinepw;
+        esine = axn * sinepw - ayn * cosepw;
+
+        const Real f = capu - epw + esine;
+        const bool converged = Tier::Fabs(f) < Tier::KeplerTolerance();
+
+        /*
+         * 1st order Newton-Raphson correction
+         */
+        const Real fdot = Real(1.0) - ecose;
+        const Real delta_epw = f / fdot;
+
+        /*
+         * the first correction is limited, later ones are 2nd order.
+         * f / (fdot - 0.5 * d2f * f/fdot)
+         */
+        const Real limited = delta_epw > max_newton_raphson
+            ? max_newton_raphson
+            : (delta_epw < -max_newton_raphson
+                    ? -max_newton_raphson
+                    : delta_epw);
+        const Real second_order = f / (fdot + Real(0.5) * esine * delta_epw);
+
+        /*
+         * Newton-Raphson correction of -F/DF
+         */
+        epw = converged
+            ? epw
+            : epw + (i == 0 ? limited : second_order);
+
+        return converged;
+    }
+
+    /**
+     * Short period periodics, position and velocity. Branch free
+     * @param[in] e eccentricity
+     * @param[in] a semi major axis
+     * @param[in] xnode right ascension of the ascending node
+     * @param[in] xincl inclination
+     * @param[in] axn
+     * @param[in] ayn
+     * @param[in] elsq
+     * @param[in] sinepw
+     * @param[in] cosepw
+     * @param[in] ecose
+     * @param[in] esine
+     * @param[in] x3thm1
+     * @param[in] x1mth2
+     * @param[in] x7thm1
+     * @param[in] cosio
+     * @param[in] sinio
+     * @param[out] position x, y, z in km
+     * @param[out] velocity x, y, z in km/s
+     * @returns lane status
+     */
+    template <typename Tier, typename Real>
+    inline int ShortPeriodic(
+            const Real a,
+            const Real xnode,
+            const Real xincl,
+            const Real axn,
+            const Real ayn,
+            const Real elsq,
+            const Real sinepw,
+            const Real cosepw,
+            const Real ecose,
+            const Real esine,
+            const Real x3thm1,
+            const Real x1mth2,
+            const Real x7thm1,
+            const Real cosio,
+            const Real sinio,
+            Real* position,
+            Real* velocity)
+    {
+        const Real xn = Real(kXKE) / Tier::Pow15(a);
+
+        /*
+         * short period preliminary quantities
+         */
+        const Real temp21 = Real(1.0) - elsq;
+        const Real pl = a * temp21;
+
+        const Real r = a * (Real(1.0) - ecose);
+        const Real temp31 = Real(1.0) / r;
+        const Real rdot = Real(kXKE) * Tier::Sqrt(a) * esine * temp31;
+        const Real rfdot = Real(kXKE) * Tier::Sqrt(pl) * temp31;
+        const Real temp32 = a * temp31;
+        const Real betal = Tier::Sqrt(temp21);
+        const Real temp33 = Real(1.0) / (Real(1.0) + betal);
+        const Real cosu = temp32 * (cosepw - axn + ayn * esine * temp33);
+        const Real sinu = temp32 * (sinepw - ayn - axn * esine * temp33);
+        const Real u = Tier::Atan2(sinu, cosu);
+        const Real sin2u = Real(2.0) * sinu * cosu;
+        const Real cos2u = Real(2.0) * cosu * cosu - Real(1.0);
+
+        /*
+         * update for short periodics
+         */
+        const Real temp41 = Real(1.0) / pl;
+        const Real temp42 = Real(kCK2) * temp41;
+        const Real temp43 = temp42 * temp41;
+
+        const Real rk = r * (Real(1.0) - Real(1.5) * temp43 * betal * x3thm1)
+            + Real(0.5) * temp42 * x1mth2 * cos2u;
+        const Real uk = u - Real(0.25) * temp43 * x7thm1 * sin2u;
+        const Real xnodek = xnode + Real(1.5) * temp43 * cosio * sin2u;
+        const Real xinck = xincl
+            + Real(1.5) * temp43 * cosio * sinio * cos2u;
+        const Real rdotk = rdot - xn * temp42 * x1mth2 * sin2u;
+        const Real rfdotk = rfdot
+            + xn * temp42 * (x1mth2 * cos2u + Real(1.5) * x3thm1);
+
+        /*
+         * orientation vectors
+         */
+        Real sinuk;
+        Real cosuk;
+        Real sinik;
+        Real cosik;
+        Real sinnok;
+        Real cosnok;
+        Tier::SinCos(uk, sinuk, cosuk);
+        Tier::SinCos(xinck, sinik, cosik);
+        Tier::SinCos(xnodek, sinnok, cosnok);
+        const Real xmx = -sinnok * cosik;
+        const Real xmy = cosnok * cosik;
+        const Real ux = xmx * sinuk + cosnok * cosuk;
+        const Real uy = xmy * sinuk + sinnok * cosuk;
+        const Real uz = sinik * sinuk;
+        const Real vx = xmx * cosuk - cosnok * sinuk;
+        const Real vy = xmy * cosuk - sinnok * sinuk;
+        const Real vz = sinik * cosuk;
+        /*
+         * position and velocity
+         */
+        position[0] = rk * ux * Real(kXKMPER);
+        position[1] = rk * uy * Real(kXKMPER);
+        position[2] = rk * uz * Real(kXKMPER);
+        velocity[0] = (rdotk * ux + rfdotk * vx) * Real(kXKMPER) / Real(60.0);
+        velocity[1] = (rdotk * uy + rfdotk * vy) * Real(kXKMPER) / Real(60.0);
+        velocity[2] = (rdotk * uz + rfdotk * vz) * Real(kXKMPER) / Real(60.0);
+
+        return pl < Real(0.0)
+            ? STATUS_PL
+            : (rk < Real(1.0) ? STATUS_DECAYED : STATUS_OK);
+    }
+
+    /**
+     * Propagate one block of near space lanes, one stage at a time. Each
+     * stage is a branch free loop over lanes reading the constants from
+     * their columns, failed lanes being masked rather than skipped, and
+     * the kepler solve runs every lane for the same number of iterations,
+     * stopping once all have converged.
+     *
+     * The loops vectorise for FastTier and VisualTier, whose math is
+     * inline, when built with e.g. -O3 -mavx2 -fno-trapping-math
+     * -fno-math-errno. ExactTier calls the standard library and so runs a
+     * lane at a time, with the results of SGP4::FindPosition().
+     *
+     * Lanes may be different satellites at one time, or, with Broadcast,
+     * one satellite at different times, its constants read from index 0
+     * of every column. The secular update always runs in double, the
+     * stages after it in the Real of the tier, double for ExactTier and
+     * FastTier and float for VisualTier. Every lane of a block uses the
+     * same model, Simple being the simple (perigee < 220km) model.
+     * @tparam Tier the precision tier
+     * @param[in] c the constants of the lanes
+     * @param[in] tsince minutes since epoch for each lane
+     * @param[in] count the number of lanes (<= kBlockSize)
+     * @param[out] position 3 * count values, x, y, z in km per lane, of
+     * no meaning where the status is not STATUS_OK
+     * @param[out] velocity 3 * count values, x, y, z in km/s per lane
+     * @param[out] status count values, status of each lane
+     */
+    template <typename Tier, bool Simple, bool Broadcast>
+    void PropagateNearSpaceBlock(
+            const LaneColumns& c,
+            const double* SGP4_RESTRICT tsince,
+            const size_t count,
+            double* SGP4_RESTRICT position,
+            double* SGP4_RESTRICT velocity,
+            int* SGP4_RESTRICT status)
+    {
+        typedef typename Tier::Real Real;
+
+        Real a[kBlockSize];
+        Real xnode[kBlockSize];
+        Real axn[kBlockSize];
+        Real ayn[kBlockSize];
+        Real capu[kBlockSize];
+        Real elsq[kBlockSize];
+        Real epw[kBlockSize];
+        Real sinepw[kBlockSize];
+        Real cosepw[kBlockSize];
+        Real ecose[kBlockSize];
+        Real esine[kBlockSize];
+        Real max_newton_raphson[kBlockSize];
+        int running[kBlockSize];
+
+        /*
+         * update for secular gravity and atmospheric drag,
+         * long period periodics
+         */
+        for (size_t j = 0; j < count; j++)
+        {
+            const size_t k = Broadcast ? 0 : j;
+
+            double secular_e;
+            double secular_a;
+            double secular_omega;
+            double secular_xl;
+            double secular_xnode;
+
+            const int secular_status = NearSpaceSecular<Tier, Simple>(c, k,
+                    tsince[j], secular_e, secular_a, secular_omega,
+                    secular_xl, secular_xnode);
+
+            const Real e = static_cast<Real>(secular_e);
+            Real omega;
+            Real xl;
+            a[j] = static_cast<Real>(secular_a);
+            Tier::NarrowAngle(secular_omega, omega);
+            Tier::NarrowAngle(secular_xl, xl);
+            Tier::NarrowAngle(secular_xnode, xnode[j]);
+
+            const int lp_status = LongPeriodic<Tier>(e, a[j], omega,
+                    xl, xnode[j],
+                    static_cast<Real>(c.xlcof[k]),
+                    static_cast<Real>(c.aycof[k]),
+                    axn[j], ayn[j], capu[j], elsq[j]);
+
+            status[j] = secular_status != STATUS_OK
+                ? secular_status
+                : lp_status;
+
+            epw[j] = capu[j];
+            sinepw[j] = Real(0.0);
+            cosepw[j] = Real(0.0);
+            ecose[j] = Real(0.0);
+            esine[j] = Real(0.0);
+            max_newton_raphson[j] = Real(1.25)
+                * Tier::Fabs(Tier::Sqrt(elsq[j]));
+            running[j] = status[j] == STATUS_OK;
+        }
+
+        /*
+         * solve keplers equation, a lane keeping its values once it has
+         * converged
+         */
+        for (int i = 0; i < Tier::KeplerIterations(); i++)
+        {
+            for (size_t j = 0; j < count; j++)
+            {
+                /*
+                 * a tier that runs a lane at a time saves the sine and
+                 * cosine of the lanes that are done
+                 */
+                if (!Tier::Vectorises() && running[j] == 0)
+                {
+                    continue;
+                }
+
+                Real step_epw = epw[j];
+                Real step_sinepw;
+                Real step_cosepw;
+                Real step_ecose;
+                Real step_esine;
+
+                const bool converged = KeplerStep<Tier>(i,
+                        capu[j], axn[j], ayn[j], max_newton_raphson[j],
+                        step_epw, step_sinepw, step_cosepw,
+                        step_ecose, step_esine);
+
+                const bool live = running[j] != 0;
+                epw[j] = live ? step_epw : epw[j];
+                sinepw[j] = live ? step_sinepw : sinepw[j];
+                cosepw[j] = live ? step_cosepw : cosepw[j];
+                ecose[j] = live ? step_ecose : ecose[j];
+                esine[j] = live ? step_esine : esine[j];
+                running[j] = live && !converged;
+            }
+
+            int any_running = 0;
+            for (size_t j = 0; j < count; j++)
+            {
+                any_running |= running[j];
+            }
+
+            if (any_running == 0)
+            {
+                break;
+            }
+        }
+
+        /*
+         * short period periodics, position and velocity
+         */
+        for (size_t j = 0; j < count; j++)
+        {
+            const size_t k = Broadcast ? 0 : j;
+
+            Real pos[3];
+            Real vel[3];
+
+            const int sp_status = ShortPeriodic<Tier>(a[j], xnode[j],
+                    static_cast<Real>(c.xincl[k]),
+                    axn[j], ayn[j], elsq[j],
+                    sinepw[j], cosepw[j], ecose[j], esine[j],
+                    static_cast<Real>(c.x3thm1[k]),
+                    static_cast<Real>(c.x1mth2[k]),
+                    static_cast<Real>(c.x7thm1[k]),
+                    static_cast<Real>(c.cosio[k]),
+                    static_cast<Real>(c.sinio[k]),
+                    pos, vel);
+
+            status[j] = status[j] != STATUS_OK ? status[j] : sp_status;
+
+            position[3 * j] = pos[0];
+            position[3 * j + 1] = pos[1];
+            position[3 * j + 2] = pos[2];
+            velocity[3 * j] = vel[0];
+            velocity[3 * j + 1] = vel[1];
+            velocity[3 * j + 2] = vel[2];
+        }
+    }
+}
+
+#endif
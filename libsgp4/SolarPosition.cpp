@@ -50,8 +50,7 @@ Eci SolarPosition::FindPosition(const DateTime& dt)
 
     Vector solar_position(R * cos(Lsa),
             R * sin(Lsa) * cos(eps),
-            R * sin(Lsa) * sin(eps),
-            R);
+            R * sin(Lsa) * sin(eps));
 
     return Eci(dt, solar_position);
 }
@@ -0,0 +1,352 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef THREADING_H_
+#define THREADING_H_
+
+/*
+ * pick the threading primitives: Win32, POSIX threads with the GCC
+ * atomic builtins, or else the C++11 library. the platform decides
+ * before the language level, so that code built as C++98 and as C++11
+ * agrees on the layout of these classes. define SGP4_NO_THREADS, or
+ * build where none of these is available, for single threaded use only
+ */
+#if defined(SGP4_NO_THREADS)
+#elif defined(_WIN32)
+#define SGP4_THREADS_WIN32
+#elif defined(__GNUC__) && (defined(__unix__) || defined(__APPLE__))
+#define SGP4_THREADS_POSIX
+#elif __cplusplus >= 201103L
+#define SGP4_THREADS_CXX11
+#else
+#define SGP4_NO_THREADS
+#endif
+
+#include <cstddef>
+#include <vector>
+
+#if defined(SGP4_THREADS_CXX11)
+#include <atomic>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#elif defined(SGP4_THREADS_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(SGP4_THREADS_POSIX)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief The locking and atomics the library needs, on each platform.
+ */
+namespace Threading
+{
+    /**
+     * @brief A mutual exclusion lock. Not copyable.
+     */
+    class Mutex
+    {
+    public:
+        Mutex()
+        {
+#if defined(SGP4_THREADS_WIN32)
+            InitializeCriticalSection(&mutex_);
+#elif defined(SGP4_THREADS_POSIX)
+            pthread_mutex_init(&mutex_, NULL);
+#endif
+        }
+
+        ~Mutex()
+        {
+#if defined(SGP4_THREADS_WIN32)
+            DeleteCriticalSection(&mutex_);
+#elif defined(SGP4_THREADS_POSIX)
+            pthread_mutex_destroy(&mutex_);
+#endif
+        }
+
+        void Lock()
+        {
+#if defined(SGP4_THREADS_CXX11)
+            mutex_.lock();
+#elif defined(SGP4_THREADS_WIN32)
+            EnterCriticalSection(&mutex_);
+#elif defined(SGP4_THREADS_POSIX)
+            pthread_mutex_lock(&mutex_);
+#endif
+        }
+
+        void Unlock()
+        {
+#if defined(SGP4_THREADS_CXX11)
+            mutex_.unlock();
+#elif defined(SGP4_THREADS_WIN32)
+            LeaveCriticalSection(&mutex_);
+#elif defined(SGP4_THREADS_POSIX)
+            pthread_mutex_unlock(&mutex_);
+#endif
+        }
+
+    private:
+        Mutex(const Mutex&);
+        Mutex& operator=(const Mutex&);
+
+#if defined(SGP4_THREADS_CXX11)
+        std::mutex mutex_;
+#elif defined(SGP4_THREADS_WIN32)
+        CRITICAL_SECTION mutex_;
+#elif defined(SGP4_THREADS_POSIX)
+        pthread_mutex_t mutex_;
+#endif
+    };
+
+    /**
+     * @brief Holds a mutex for its lifetime, so a throw releases it.
+     */
+    class ScopedLock
+    {
+    public:
+        explicit ScopedLock(Mutex& mutex)
+            : mutex_(mutex)
+        {
+            mutex_.Lock();
+        }
+
+        ~ScopedLock()
+        {
+            mutex_.Unlock();
+        }
+
+    private:
+        ScopedLock(const ScopedLock&);
+        ScopedLock& operator=(const ScopedLock&);
+
+        Mutex& mutex_;
+    };
+
+    /**
+     * @brief A flag read with acquire and written with release ordering.
+     * Not copyable.
+     */
+    class AtomicBool
+    {
+    public:
+        explicit AtomicBool(bool value)
+            : value_(value)
+        {
+        }
+
+        bool Load() const
+        {
+#if defined(SGP4_THREADS_CXX11)
+            return value_.load(std::memory_order_acquire);
+#elif defined(SGP4_THREADS_WIN32)
+            return InterlockedCompareExchange(&value_, 0, 0) != 0;
+#elif defined(SGP4_THREADS_POSIX)
+            return __atomic_load_n(&value_, __ATOMIC_ACQUIRE);
+#else
+            return value_;
+#endif
+        }
+
+        void Store(bool value)
+        {
+#if defined(SGP4_THREADS_CXX11)
+            value_.store(value, std::memory_order_release);
+#elif defined(SGP4_THREADS_WIN32)
+            InterlockedExchange(&value_, value ? 1 : 0);
+#elif defined(SGP4_THREADS_POSIX)
+            __atomic_store_n(&value_, value, __ATOMIC_RELEASE);
+#else
+            value_ = value;
+#endif
+        }
+
+    private:
+        AtomicBool(const AtomicBool&);
+        AtomicBool& operator=(const AtomicBool&);
+
+#if defined(SGP4_THREADS_CXX11)
+        std::atomic<bool> value_;
+#elif defined(SGP4_THREADS_WIN32)
+        mutable volatile LONG value_;
+#else
+        bool value_;
+#endif
+    };
+
+    /**
+     * @brief A counter workers take their next item from. Not copyable.
+     */
+    class AtomicCounter
+    {
+    public:
+        AtomicCounter()
+            : value_(0)
+        {
+        }
+
+        /**
+         * @returns the value before adding one
+         */
+        size_t Next()
+        {
+#if defined(SGP4_THREADS_CXX11)
+            return value_.fetch_add(1, std::memory_order_relaxed);
+#elif defined(SGP4_THREADS_WIN32)
+            return static_cast<size_t>(InterlockedIncrement(&value_) - 1);
+#elif defined(SGP4_THREADS_POSIX)
+            return __atomic_fetch_add(&value_, 1, __ATOMIC_RELAXED);
+#else
+            return value_++;
+#endif
+        }
+
+    private:
+        AtomicCounter(const AtomicCounter&);
+        AtomicCounter& operator=(const AtomicCounter&);
+
+#if defined(SGP4_THREADS_CXX11)
+        std::atomic<size_t> value_;
+#elif defined(SGP4_THREADS_WIN32)
+        volatile LONG value_;
+#else
+        size_t value_;
+#endif
+    };
+
+    /**
+     * @returns the number of processors online, 1 where it is not known
+     * or there are no threads
+     */
+    inline unsigned int ProcessorCount()
+    {
+#if defined(SGP4_THREADS_CXX11)
+        const unsigned int processors = std::thread::hardware_concurrency();
+        return processors > 0 ? processors : 1;
+#elif defined(SGP4_THREADS_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#elif defined(SGP4_THREADS_POSIX)
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        return processors > 0 ? static_cast<unsigned int>(processors) : 1;
+#else
+        return 1;
+#endif
+    }
+
+#if defined(SGP4_THREADS_WIN32)
+    /*
+     * the work and argument of a Win32 thread
+     */
+    struct WorkerStart
+    {
+        void* (*work)(void*);
+        void* arg;
+    };
+
+    inline DWORD WINAPI WorkerThread(LPVOID param)
+    {
+        const WorkerStart* start = static_cast<const WorkerStart*>(param);
+        start->work(start->arg);
+        return 0;
+    }
+#endif
+
+    /**
+     * Run work(arg) on count threads, this one among them, and wait for
+     * all of them. Where a thread cannot be started, or there are no
+     * threads, fewer run, so the work should take its items from a shared
+     * AtomicCounter until none are left
+     * @param[in] work the function each thread runs
+     * @param[in] arg its argument
+     * @param[in] count the number of threads
+     */
+    inline void RunWorkers(void* (*work)(void*), void* arg, size_t count)
+    {
+#if defined(SGP4_THREADS_CXX11)
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < count; i++)
+        {
+            try
+            {
+                workers.push_back(std::thread(work, arg));
+            }
+            catch (const std::system_error&)
+            {
+            }
+        }
+
+        work(arg);
+
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            workers[i].join();
+        }
+#elif defined(SGP4_THREADS_WIN32)
+        WorkerStart start;
+        start.work = work;
+        start.arg = arg;
+
+        std::vector<HANDLE> workers;
+        for (size_t i = 1; i < count; i++)
+        {
+            HANDLE worker = CreateThread(NULL, 0, &WorkerThread, &start,
+                    0, NULL);
+            if (worker != NULL)
+            {
+                workers.push_back(worker);
+            }
+        }
+
+        work(arg);
+
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            WaitForSingleObject(workers[i], INFINITE);
+            CloseHandle(workers[i]);
+        }
+#elif defined(SGP4_THREADS_POSIX)
+        std::vector<pthread_t> workers;
+        for (size_t i = 1; i < count; i++)
+        {
+            pthread_t worker;
+            if (pthread_create(&worker, NULL, work, arg) == 0)
+            {
+                workers.push_back(worker);
+            }
+        }
+
+        work(arg);
+
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            pthread_join(workers[i], NULL);
+        }
+#else
+        (void)count;
+        work(arg);
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TIMECONTEXT_H_
+#define TIMECONTEXT_H_
+
+#include "DateTime.h"
+#include "Util.h"
+
+#include <cmath>
+
+/**
+ * @brief The earth orientation quantities of one instant.
+ *
+ * Computes the julian date, the greenwich mean sidereal time and its
+ * sin/cos once, so that converting many positions at the same time does
+ * not repeat the work. Pass it to the Eci and Observer overloads that take
+ * a TimeContext; the positions given to them must be for the same time.
+ */
+class TimeContext
+{
+public:
+    /**
+     * @param[in] dt the instant
+     */
+    explicit TimeContext(const DateTime& dt)
+        : m_dt(dt),
+        m_julian(dt.ToJulian()),
+        m_gmst(dt.ToGreenwichSiderealTime()),
+        m_sin_gmst(sin(m_gmst)),
+        m_cos_gmst(cos(m_gmst))
+    {
+    }
+
+    /**
+     * @param[in] dt the instant
+     * @param[in] gmst the greenwich mean sidereal time of dt in radians
+     * @param[in] sin_gmst the sine of gmst
+     * @param[in] cos_gmst the cosine of gmst
+     */
+    TimeContext(
+            const DateTime& dt,
+            const double gmst,
+            const double sin_gmst,
+            const double cos_gmst)
+        : m_dt(dt),
+        m_julian(dt.ToJulian()),
+        m_gmst(gmst),
+        m_sin_gmst(sin_gmst),
+        m_cos_gmst(cos_gmst)
+    {
+    }
+
+    /**
+     * @returns the instant
+     */
+    const DateTime& GetDateTime() const
+    {
+        return m_dt;
+    }
+
+    /**
+     * @returns the julian date
+     */
+    double Julian() const
+    {
+        return m_julian;
+    }
+
+    /**
+     * @returns the greenwich mean sidereal time in radians
+     */
+    double GreenwichSiderealTime() const
+    {
+        return m_gmst;
+    }
+
+    /**
+     * @returns the sine of the greenwich mean sidereal time
+     */
+    double SinGreenwichSiderealTime() const
+    {
+        return m_sin_gmst;
+    }
+
+    /**
+     * @returns the cosine of the greenwich mean sidereal time
+     */
+    double CosGreenwichSiderealTime() const
+    {
+        return m_cos_gmst;
+    }
+
+    /**
+     * @param[in] lon the observers longitude in radians
+     * @returns the local mean sidereal time
+     */
+    double LocalMeanSiderealTime(const double lon) const
+    {
+        return Util::WrapTwoPI(m_gmst + lon);
+    }
+
+private:
+    DateTime m_dt;
+    double m_julian;
+    double m_gmst;
+    double m_sin_gmst;
+    double m_cos_gmst;
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "TimeGrid.h"
+
+#include "Globals.h"
+#include "Util.h"
+
+#include <cmath>
+
+const size_t TimeGrid::kAnchorInterval;
+
+TimeGrid::TimeGrid(
+        const DateTime& start,
+        const TimeSpan& step,
+        const size_t count)
+    : start_(start),
+    step_(step),
+    count_(count)
+{
+    ComputeRotation();
+}
+
+TimeGrid::TimeGrid(
+        const DateTime& start,
+        const DateTime& end,
+        const TimeSpan& step)
+    : start_(start),
+    step_(step),
+    count_(0)
+{
+    const long long span = (end - start).Ticks();
+
+    if (span > 0 && step.Ticks() > 0)
+    {
+        count_ = static_cast<size_t>((span + step.Ticks() - 1) / step.Ticks());
+    }
+
+    ComputeRotation();
+}
+
+void TimeGrid::TimesSince(
+        const DateTime& epoch,
+        std::vector<double>& tsince) const
+{
+    tsince.resize(count_);
+
+    /*
+     * in whole ticks, so each value is what DateTime arithmetic gives
+     */
+    const long long offset = start_.Ticks() - epoch.Ticks();
+
+    for (size_t i = 0; i < count_; i++)
+    {
+        tsince[i] = TimeSpan(offset
+                + static_cast<long long>(i) * step_.Ticks()).TotalMinutes();
+    }
+}
+
+std::vector<DateTime> TimeGrid::Times() const
+{
+    std::vector<DateTime> times;
+    times.reserve(count_);
+
+    for (size_t i = 0; i < count_; i++)
+    {
+        times.push_back(At(i));
+    }
+
+    return times;
+}
+
+/**
+ * Fill in the earth rotation of every time
+ */
+void TimeGrid::ComputeRotation()
+{
+    gmst_.resize(count_);
+    sin_gmst_.resize(count_);
+    cos_gmst_.resize(count_);
+
+    if (count_ == 0)
+    {
+        return;
+    }
+
+    /*
+     * the rotation per step, from the derivative of the sidereal time
+     * polynomial in DateTime::ToGreenwichSiderealTime (seconds of time per
+     * julian century, 240 per degree). differencing two evaluations instead
+     * would carry the rounding of the julian date into every step
+     */
+    const double t = (start_.ToJulian() - 2451545.0) / 36525.0;
+    const double rate = (876600.0 * 3600.0 + 8640184.812866
+            + 2.0 * 0.093104 * t
+            - 3.0 * 0.0000062 * t * t) / 36525.0 / 240.0;
+    const double delta = Util::WrapNegPosPI(
+            Util::DegreesToRadians(rate * step_.TotalDays()));
+    const double sin_delta = sin(delta);
+    const double cos_delta = cos(delta);
+
+    for (size_t i = 0; i < count_; i++)
+    {
+        if (i % kAnchorInterval == 0)
+        {
+            const double gmst = At(i).ToGreenwichSiderealTime();
+
+            gmst_[i] = gmst;
+            sin_gmst_[i] = sin(gmst);
+            cos_gmst_[i] = cos(gmst);
+        }
+        else
+        {
+            const double s = sin_gmst_[i - 1];
+            const double c = cos_gmst_[i - 1];
+
+            gmst_[i] = Util::WrapTwoPI(gmst_[i - 1] + delta);
+            sin_gmst_[i] = s * cos_delta + c * sin_delta;
+            cos_gmst_[i] = c * cos_delta - s * sin_delta;
+        }
+    }
+}
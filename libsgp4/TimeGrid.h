@@ -0,0 +1,160 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TIMEGRID_H_
+#define TIMEGRID_H_
+
+#include "DateTime.h"
+#include "TimeSpan.h"
+#include "TimeContext.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Evenly spaced times: a start, a step and a count.
+ *
+ * Sampling loops can take the minutes since an epoch for every time
+ * directly, without stepping DateTime objects. The earth rotation of every
+ * time is computed when the grid is made: the sin/cos of the greenwich
+ * mean sidereal time are advanced by a fixed rotation per step and
+ * re-anchored to the exact value every kAnchorInterval steps, so the
+ * sidereal time polynomial and its trig are evaluated once per interval
+ * rather than once per time. The values agree with
+ * DateTime::ToGreenwichSiderealTime() to within 1e-8 radians, the rounding
+ * of the julian date it is computed from.
+ */
+class TimeGrid
+{
+public:
+    /**
+     * @param[in] start the first time
+     * @param[in] step the time between samples
+     * @param[in] count the number of times
+     */
+    TimeGrid(const DateTime& start, const TimeSpan& step, const size_t count);
+
+    /**
+     * Every step from start up to, but not including, end
+     * @param[in] start the first time
+     * @param[in] end the end of the span
+     * @param[in] step the time between samples, positive
+     */
+    TimeGrid(const DateTime& start, const DateTime& end, const TimeSpan& step);
+
+    virtual ~TimeGrid()
+    {
+    }
+
+    /**
+     * @returns the number of times
+     */
+    size_t Count() const
+    {
+        return count_;
+    }
+
+    /**
+     * @returns the first time
+     */
+    const DateTime& Start() const
+    {
+        return start_;
+    }
+
+    /**
+     * @returns the time between samples
+     */
+    const TimeSpan& Step() const
+    {
+        return step_;
+    }
+
+    /**
+     * @param[in] i the index of the time
+     * @returns the time
+     */
+    DateTime At(const size_t i) const
+    {
+        return start_.AddTicks(static_cast<long long>(i) * step_.Ticks());
+    }
+
+    /**
+     * @param[in] i the index of the time
+     * @returns the earth orientation at the time
+     */
+    TimeContext Context(const size_t i) const
+    {
+        return TimeContext(At(i), gmst_[i], sin_gmst_[i], cos_gmst_[i]);
+    }
+
+    /**
+     * @param[in] i the index of the time
+     * @returns the greenwich mean sidereal time in radians
+     */
+    double GreenwichSiderealTime(const size_t i) const
+    {
+        return gmst_[i];
+    }
+
+    /**
+     * @param[in] i the index of the time
+     * @returns the sine of the greenwich mean sidereal time
+     */
+    double SinGreenwichSiderealTime(const size_t i) const
+    {
+        return sin_gmst_[i];
+    }
+
+    /**
+     * @param[in] i the index of the time
+     * @returns the cosine of the greenwich mean sidereal time
+     */
+    double CosGreenwichSiderealTime(const size_t i) const
+    {
+        return cos_gmst_[i];
+    }
+
+    /**
+     * @param[in] epoch the epoch to measure from
+     * @param[out] tsince the minutes since epoch of every time, exactly
+     * as (At(i) - epoch).TotalMinutes()
+     */
+    void TimesSince(const DateTime& epoch, std::vector<double>& tsince) const;
+
+    /**
+     * @returns every time as a DateTime
+     */
+    std::vector<DateTime> Times() const;
+
+    /*
+     * the number of steps between exact sidereal time evaluations
+     */
+    static const size_t kAnchorInterval = 32;
+
+private:
+    void ComputeRotation();
+
+    DateTime start_;
+    TimeSpan step_;
+    size_t count_;
+    std::vector<double> gmst_;
+    std::vector<double> sin_gmst_;
+    std::vector<double> cos_gmst_;
+};
+
+#endif
@@ -17,7 +17,6 @@
 
 #include "Tle.h"
 
-#include <locale> 
 
 namespace
 {
@@ -60,6 +59,36 @@ namespace
     static const unsigned int TLE2_LEN_MEANMOTION = 11;
     static const unsigned int TLE2_COL_REVATEPOCH = 63;
     static const unsigned int TLE2_LEN_REVATEPOCH = 5;
+
+    /*
+     * the powers of ten which are exact in a double
+     */
+    static const double kPowersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    /*
+     * not isdigit(), which consults the locale
+     */
+    inline bool IsDigit(const char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    /*
+     * digits * 10^exponent. the fields hold fewer than 16 digits, so
+     * digits is an exact integer and the one multiply or divide by an
+     * exact power of ten rounds correctly, as converting the text would
+     */
+    inline double Scale(const double digits, const int exponent)
+    {
+        if (exponent >= 0)
+        {
+            return digits * kPowersOfTen[exponent];
+        }
+        return digits / kPowersOfTen[-exponent];
+    }
 }
 
 /**
@@ -91,10 +120,10 @@ void Tle::Initialize()
     unsigned int sat_number_1;
     unsigned int sat_number_2;
 
-    ExtractInteger(line_one_.substr(TLE1_COL_NORADNUM,
-                TLE1_LEN_NORADNUM), sat_number_1);
-    ExtractInteger(line_two_.substr(TLE2_COL_NORADNUM,
-                TLE2_LEN_NORADNUM), sat_number_2);
+    ExtractInteger(line_one_, TLE1_COL_NORADNUM,
+            TLE1_LEN_NORADNUM, sat_number_1);
+    ExtractInteger(line_two_, TLE2_COL_NORADNUM,
+            TLE2_LEN_NORADNUM, sat_number_2);
 
     if (sat_number_1 != sat_number_2)
     {
@@ -105,43 +134,49 @@ void Tle::Initialize()
 
     if (name_.empty())
     {
-        name_ = line_one_.substr(TLE1_COL_NORADNUM, TLE1_LEN_NORADNUM);
+        name_.assign(line_one_, TLE1_COL_NORADNUM, TLE1_LEN_NORADNUM);
     }
 
-    int_designator_ = line_one_.substr(TLE1_COL_INTLDESC_A,
+    int_designator_.assign(line_one_, TLE1_COL_INTLDESC_A,
             TLE1_LEN_INTLDESC_A + TLE1_LEN_INTLDESC_B + TLE1_LEN_INTLDESC_C);
 
     unsigned int year = 0;
     double day = 0.0;
 
-    ExtractInteger(line_one_.substr(TLE1_COL_EPOCH_A,
-                TLE1_LEN_EPOCH_A), year);
-    ExtractDouble(line_one_.substr(TLE1_COL_EPOCH_B,
-                TLE1_LEN_EPOCH_B), 4, day);
-    ExtractDouble(line_one_.substr(TLE1_COL_MEANMOTIONDT2,
-                TLE1_LEN_MEANMOTIONDT2), 2, mean_motion_dt2_);
-    ExtractExponential(line_one_.substr(TLE1_COL_MEANMOTIONDDT6,
-                TLE1_LEN_MEANMOTIONDDT6), mean_motion_ddt6_);
-    ExtractExponential(line_one_.substr(TLE1_COL_BSTAR,
-                TLE1_LEN_BSTAR), bstar_);
+    ExtractInteger(line_one_, TLE1_COL_EPOCH_A,
+            TLE1_LEN_EPOCH_A, year);
+    ExtractDouble(line_one_, TLE1_COL_EPOCH_B,
+            TLE1_LEN_EPOCH_B, 4, day);
+    ExtractDouble(line_one_, TLE1_COL_MEANMOTIONDT2,
+            TLE1_LEN_MEANMOTIONDT2, 2, mean_motion_dt2_);
+    ExtractExponential(line_one_, TLE1_COL_MEANMOTIONDDT6,
+            TLE1_LEN_MEANMOTIONDDT6, mean_motion_ddt6_);
+    ExtractExponential(line_one_, TLE1_COL_BSTAR,
+            TLE1_LEN_BSTAR, bstar_);
+    /*
+     * nothing is derived from the element set number, so a malformed one
+     * does not reject the element set
+     */
+    ExtractLenientInteger(line_one_, TLE1_COL_ELNUM,
+            TLE1_LEN_ELNUM, element_number_);
 
     /*
      * line 2
      */
-    ExtractDouble(line_two_.substr(TLE2_COL_INCLINATION,
-                TLE2_LEN_INCLINATION), 4, inclination_);
-    ExtractDouble(line_two_.substr(TLE2_COL_RAASCENDNODE,
-                TLE2_LEN_RAASCENDNODE), 4, right_ascending_node_);
-    ExtractDouble(line_two_.substr(TLE2_COL_ECCENTRICITY,
-                TLE2_LEN_ECCENTRICITY), -1, eccentricity_);
-    ExtractDouble(line_two_.substr(TLE2_COL_ARGPERIGEE,
-                TLE2_LEN_ARGPERIGEE), 4, argument_perigee_);
-    ExtractDouble(line_two_.substr(TLE2_COL_MEANANOMALY,
-                TLE2_LEN_MEANANOMALY), 4, mean_anomaly_);
-    ExtractDouble(line_two_.substr(TLE2_COL_MEANMOTION,
-                TLE2_LEN_MEANMOTION), 3, mean_motion_);
-    ExtractInteger(line_two_.substr(TLE2_COL_REVATEPOCH,
-                TLE2_LEN_REVATEPOCH), orbit_number_);
+    ExtractDouble(line_two_, TLE2_COL_INCLINATION,
+            TLE2_LEN_INCLINATION, 4, inclination_);
+    ExtractDouble(line_two_, TLE2_COL_RAASCENDNODE,
+            TLE2_LEN_RAASCENDNODE, 4, right_ascending_node_);
+    ExtractDouble(line_two_, TLE2_COL_ECCENTRICITY,
+            TLE2_LEN_ECCENTRICITY, -1, eccentricity_);
+    ExtractDouble(line_two_, TLE2_COL_ARGPERIGEE,
+            TLE2_LEN_ARGPERIGEE, 4, argument_perigee_);
+    ExtractDouble(line_two_, TLE2_COL_MEANANOMALY,
+            TLE2_LEN_MEANANOMALY, 4, mean_anomaly_);
+    ExtractDouble(line_two_, TLE2_COL_MEANMOTION,
+            TLE2_LEN_MEANMOTION, 3, mean_motion_);
+    ExtractInteger(line_two_, TLE2_COL_REVATEPOCH,
+            TLE2_LEN_REVATEPOCH, orbit_number_);
     
     if (year < 57)
         year += 2000;
@@ -161,19 +196,27 @@ bool Tle::IsValidLineLength(const std::string& str)
 }
 
 /**
- * Convert a string containing an integer
- * @param[in] str The string to convert
+ * Convert a field containing an integer
+ * @param[in] line The line holding the field
+ * @param[in] column The first column of the field
+ * @param[in] length The width of the field
  * @param[out] val The result
  * @exception TleException on conversion error
  */
-void Tle::ExtractInteger(const std::string& str, unsigned int& val)
+void Tle::ExtractInteger(
+        const std::string& line,
+        unsigned int column,
+        unsigned int length,
+        unsigned int& val)
 {
+    const char* begin = line.data() + column;
+    const char* end = begin + length;
     bool found_digit = false;
     unsigned int temp = 0;
 
-    for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    for (const char* i = begin; i != end; ++i)
     {
-        if (isdigit(*i))
+        if (IsDigit(*i))
         {
             found_digit = true;
             temp = (temp * 10) + (*i - '0');
@@ -199,169 +242,180 @@ void Tle::ExtractInteger(const std::string& str, unsigned int& val)
 }
 
 /**
- * Convert a string containing an double
- * @param[in] str The string to convert
+ * Convert a field containing an integer, or give 0 where it is not one
+ * @param[in] line The line holding the field
+ * @param[in] column The first column of the field
+ * @param[in] length The width of the field
+ * @param[out] val The result
+ */
+void Tle::ExtractLenientInteger(
+        const std::string& line,
+        unsigned int column,
+        unsigned int length,
+        unsigned int& val)
+{
+    try
+    {
+        ExtractInteger(line, column, length, val);
+    }
+    catch (const TleException&)
+    {
+        val = 0;
+    }
+}
+
+/**
+ * Convert a field containing an double
+ * @param[in] line The line holding the field
+ * @param[in] column The first column of the field
+ * @param[in] length The width of the field
  * @param[in] point_pos The position of the decimal point. (-1 if none)
  * @param[out] val The result
  * @exception TleException on conversion error
  */
-void Tle::ExtractDouble(const std::string& str, int point_pos, double& val)
+void Tle::ExtractDouble(
+        const std::string& line,
+        unsigned int column,
+        unsigned int length,
+        int point_pos,
+        double& val)
 {
-    std::string temp;
+    const char* begin = line.data() + column;
+    const char* end = begin + length;
+    const char* point = point_pos >= 0 ? begin + point_pos - 1 : NULL;
+    bool negative = false;
     bool found_digit = false;
+    double digits = 0.0;
+    int fraction_digits = 0;
 
-    for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    for (const char* i = begin; i != end; ++i)
     {
         /*
          * integer part
          */
-        if (point_pos >= 0 && i < str.begin() + point_pos - 1)
+        if (point != NULL && i < point)
         {
-            bool done = false;
-
-            if (i == str.begin())
+            if (i == begin && (*i == '-' || *i == '+'))
+            {
+                /*
+                 * first character could be signed
+                 */
+                negative = *i == '-';
+            }
+            else if (IsDigit(*i))
             {
-                if(*i == '-' || *i == '+')
-                {
-                    /*
-                     * first character could be signed
-                     */
-                    temp += *i;
-                    done = true;
-                }
+                found_digit = true;
+                digits = digits * 10.0 + (*i - '0');
             }
-
-            if (!done)
+            else if (found_digit)
             {
-                if (isdigit(*i))
-                {
-                    found_digit = true;
-                    temp += *i;
-                }
-                else if (found_digit)
-                {
-                    throw TleException("Unexpected non digit");
-                }
-                else if (*i != ' ')
-                {
-                    throw TleException("Invalid character");
-                }
+                throw TleException("Unexpected non digit");
+            }
+            else if (*i != ' ')
+            {
+                throw TleException("Invalid character");
             }
         }
         /*
          * decimal point
          */
-        else if (point_pos >= 0 && i == str.begin() + point_pos - 1)
+        else if (i == point)
         {
-            if (temp.length() == 0)
-            {
-                /*
-                 * integer part is blank, so add a '0'
-                 */
-                temp += '0';
-            }
-
-            if (*i == '.')
-            {
-                /*
-                 * decimal point found
-                 */
-                temp += *i;
-            }
-            else
+            if (*i != '.')
             {
                 throw TleException("Failed to find decimal point");
             }
         }
         /*
-         * fraction part
+         * fraction part, or the whole field when no decimal point is
+         * expected
          */
         else
         {
-            if (i == str.begin() && point_pos == -1)
-            {
-                /*
-                 * no decimal point expected, add 0. beginning
-                 */
-                temp += '0';
-                temp += '.';
-            }
-            
-            /*
-             * should be a digit
-             */
-            if (isdigit(*i))
-            {
-                temp += *i;
-            }
-            else
+            if (!IsDigit(*i))
             {
                 throw TleException("Invalid digit");
             }
+            digits = digits * 10.0 + (*i - '0');
+            fraction_digits++;
         }
     }
 
-    if (!Util::FromString<double>(temp, val))
+    val = Scale(digits, -fraction_digits);
+    if (negative)
     {
-        throw TleException("Failed to convert value to double");
+        val = -val;
     }
 }
 
 /**
- * Convert a string containing an exponential
- * @param[in] str The string to convert
+ * Convert a field containing an exponential
+ * @param[in] line The line holding the field
+ * @param[in] column The first column of the field
+ * @param[in] length The width of the field
  * @param[out] val The result
  * @exception TleException on conversion error
  */
-void Tle::ExtractExponential(const std::string& str, double& val)
+void Tle::ExtractExponential(
+        const std::string& line,
+        unsigned int column,
+        unsigned int length,
+        double& val)
 {
-    std::string temp;
+    const char* begin = line.data() + column;
+    const char* end = begin + length;
+    bool negative = false;
+    bool negative_exponent = false;
+    double digits = 0.0;
+    int fraction_digits = 0;
+    int exponent = 0;
 
-    for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    for (const char* i = begin; i != end; ++i)
     {
-        if (i == str.begin())
+        if (i == begin)
         {
             if (*i == '-' || *i == '+' || *i == ' ')
             {
-                if (*i == '-')
-                {
-                    temp += *i;
-                }
-                temp += '0';
-                temp += '.';
+                negative = *i == '-';
             }
             else
             {
                 throw TleException("Invalid sign");
             }
         }
-        else if (i == str.begin() + str.length() - 2)
+        else if (i == end - 2)
         {
             if (*i == '-' || *i == '+')
             {
-                temp += 'e';
-                temp += *i;
+                negative_exponent = *i == '-';
             }
             else
             {
                 throw TleException("Invalid exponential sign");
             }
         }
+        else if (!IsDigit(*i))
+        {
+            throw TleException("Invalid digit");
+        }
+        else if (i == end - 1)
+        {
+            exponent = *i - '0';
+        }
         else
         {
-            if (isdigit(*i))
-            {
-                temp += *i;
-            }
-            else
-            {
-                throw TleException("Invalid digit");
-            }
+            /*
+             * the mantissa has an implied leading decimal point
+             */
+            digits = digits * 10.0 + (*i - '0');
+            fraction_digits++;
         }
     }
 
-    if (!Util::FromString<double>(temp, val))
+    val = Scale(digits,
+            (negative_exponent ? -exponent : exponent) - fraction_digits);
+    if (negative)
     {
-        throw TleException("Failed to convert value to double");
+        val = -val;
     }
 }
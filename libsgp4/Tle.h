@@ -35,11 +35,11 @@ public:
      * @param[in] line_one Tle line one
      * @param[in] line_two Tle line two
      */
-    Tle(const std::string& line_one,
-            const std::string& line_two)
-        : line_one_(line_one),
-        line_two_(line_two)
+    Tle(std::string line_one,
+            std::string line_two)
     {
+        line_one_.swap(line_one);
+        line_two_.swap(line_two);
         Initialize();
     }
 
@@ -49,40 +49,25 @@ public:
      * @param[in] line_one Tle line one
      * @param[in] line_two Tle line two
      */
-    Tle(const std::string& name,
-            const std::string& line_one,
-            const std::string& line_two)
-        : name_(name),
-        line_one_(line_one),
-        line_two_(line_two)
+    Tle(std::string name,
+            std::string line_one,
+            std::string line_two)
     {
+        name_.swap(name);
+        line_one_.swap(line_one);
+        line_two_.swap(line_two);
         Initialize();
     }
 
-    /**
-     * Copy constructor
-     * @param[in] tle Tle object to copy from
+#if __cplusplus >= 201103L
+    /*
+     * the virtual destructor would otherwise suppress the moves
      */
-    Tle(const Tle& tle)
-    {
-        name_ = tle.name_;
-        line_one_ = tle.line_one_;
-        line_two_ = tle.line_two_;
-
-        norad_number_ = tle.norad_number_;
-        int_designator_ = tle.int_designator_;
-        epoch_ = tle.epoch_;
-        mean_motion_dt2_ = tle.mean_motion_dt2_;
-        mean_motion_ddt6_ = tle.mean_motion_ddt6_;
-        bstar_ = tle.bstar_;
-        inclination_ = tle.inclination_;
-        right_ascending_node_ = tle.right_ascending_node_;
-        eccentricity_ = tle.eccentricity_;
-        argument_perigee_ = tle.argument_perigee_;
-        mean_anomaly_ = tle.mean_anomaly_;
-        mean_motion_ = tle.mean_motion_;
-        orbit_number_ = tle.orbit_number_;
-    }
+    Tle(const Tle& tle) = default;
+    Tle(Tle&& tle) = default;
+    Tle& operator=(const Tle& tle) = default;
+    Tle& operator=(Tle&& tle) = default;
+#endif
 
     /**
      * Destructor
@@ -267,6 +252,17 @@ public:
         return orbit_number_;
     }
 
+    /**
+     * Get the element set number, which the issuer increments with each
+     * new element set of the satellite
+     * @returns the element set number, 0 where the field is blank or not
+     * a number
+     */
+    unsigned int ElementNumber() const
+    {
+        return element_number_;
+    }
+
     /**
      * Get the expected tle line length
      * @returns the tle line length
@@ -311,11 +307,34 @@ public:
     }
 
 private:
+    friend class Catalog;
+
+    /*
+     * for Catalog, which fills in every field from an image
+     */
+    Tle()
+    {
+    }
+
     void Initialize();
     static bool IsValidLineLength(const std::string& str);
-    void ExtractInteger(const std::string& str, unsigned int& val);
-    void ExtractDouble(const std::string& str, int point_pos, double& val);
-    void ExtractExponential(const std::string& str, double& val);
+    static void ExtractInteger(const std::string& line,
+            unsigned int column,
+            unsigned int length,
+            unsigned int& val);
+    static void ExtractLenientInteger(const std::string& line,
+            unsigned int column,
+            unsigned int length,
+            unsigned int& val);
+    static void ExtractDouble(const std::string& line,
+            unsigned int column,
+            unsigned int length,
+            int point_pos,
+            double& val);
+    static void ExtractExponential(const std::string& line,
+            unsigned int column,
+            unsigned int length,
+            double& val);
 
 private:
     std::string name_;
@@ -335,6 +354,7 @@ private:
     double mean_anomaly_;
     double mean_motion_;
     unsigned int orbit_number_;
+    unsigned int element_number_;
 
     static const unsigned int TLE_LEN_LINE_DATA = 69;
     static const unsigned int TLE_LEN_LINE_NAME = 22;
@@ -26,7 +26,8 @@
 /**
  * @brief Generic vector
  *
- * Stores x, y, z, w
+ * Stores x, y, z. Vector is trivially copyable and standard layout, so
+ * arrays of it can be copied with memcpy and written directly.
  */
 struct Vector
 {
@@ -36,7 +37,7 @@ public:
      * Default constructor
      */
     Vector()
-        : x(0.0), y(0.0), z(0.0), w(0.0)
+        : x(0.0), y(0.0), z(0.0)
     {
     }
 
@@ -49,60 +50,10 @@ public:
     Vector(const double arg_x,
             const double arg_y,
             const double arg_z)
-        : x(arg_x), y(arg_y), z(arg_z), w(0.0)
-    {
-    }
-
-    /**
-     * Constructor
-     * @param arg_x x value
-     * @param arg_y y value
-     * @param arg_z z value
-     * @param arg_w w value
-     */
-    Vector(const double arg_x,
-            const double arg_y,
-            const double arg_z,
-            const double arg_w)
-        : x(arg_x), y(arg_y), z(arg_z), w(arg_w)
+        : x(arg_x), y(arg_y), z(arg_z)
     {
     }
     
-    /**
-     * Copy constructor
-     * @param v value to copy from
-     */
-    Vector(const Vector& v)
-    {
-        x = v.x;
-        y = v.y;
-        z = v.z;
-        w = v.w;
-    }
-
-    /**
-     * Destructor
-     */
-    virtual ~Vector()
-    {
-    }
-
-    /**
-     * Assignment operator
-     * @param v value to copy from
-     */
-    Vector& operator=(const Vector& v)
-    {
-        if (this != &v)
-        {
-            x = v.x;
-            y = v.y;
-            z = v.z;
-            w = v.w;
-        }
-        return *this;
-    }
-
     /**
      * Subtract operator
      * @param v value to suctract from
@@ -111,8 +62,7 @@ public:
     {
         return Vector(x - v.x,
                 y - v.y,
-                z - v.z,
-                0.0);
+                z - v.z);
     }
 
     /**
@@ -146,7 +96,6 @@ public:
         ss << "X: " << std::setw(9) << x;
         ss << ", Y: " << std::setw(9) << y;
         ss << ", Z: " << std::setw(9) << z;
-        ss << ", W: " << std::setw(9) << w;
         return ss.str();
     }
 
@@ -156,8 +105,6 @@ public:
     double y;
     /** z value */
     double z;
-    /** w value */
-    double w;
 };
 
 inline std::ostream& operator<<(std::ostream& strm, const Vector& v)
@@ -0,0 +1,316 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef VECTORMATH_H_
+#define VECTORMATH_H_
+
+#include <cmath>
+
+/**
+ * @brief Trigonometric kernels for loops over lanes.
+ *
+ * The standard library functions are calls the compiler cannot vectorise,
+ * so a loop containing one runs a lane at a time. These are inline and
+ * branch free, every branch being a select between two computed values,
+ * so a loop over lanes calling them vectorises like the rest of its body.
+ * GCC needs -fno-trapping-math -fno-math-errno (with e.g. -O3 -mavx2) to
+ * if-convert the selects and inline sqrt; without them the results are
+ * the same, one lane at a time. They are Cody-Waite range reduction and
+ * the polynomial and rational approximations of Cephes.
+ *
+ * Largest errors measured against correctly rounded results, in units in
+ * the last place of the result type:
+ *
+ *   function  double                    float
+ *   SinCos    1.6 ulp, 2.4 to |x| = 1e5  1.6 ulp, 6.3 to |x| = 100
+ *   Atan2     2.3 ulp                   2.8 ulp
+ *   Asin      2.8 ulp                   3.6 ulp
+ *
+ * Beyond |x| = 100 the float SinCos keeps an absolute error below 1e-7
+ * up to 1e4; past that the reduction loses all precision, but the
+ * quadrant is kept in floating point, so no input is undefined and NaN
+ * gives NaN. Atan2 does not tell signed zeros apart, atan2(0, -0) is 0.
+ * Define SGP4_SCALAR_MATH to use the standard library instead.
+ */
+namespace VectorMath
+{
+    /**
+     * truncation toward zero. GCC only treats trunc() as a builtin it can
+     * vectorise outside of the strict ISO C++98 mode
+     * @param[in] x
+     * @returns x without its fraction
+     */
+    inline double Trunc(const double x)
+    {
+#if defined(__GNUC__)
+        return __builtin_trunc(x);
+#else
+        return trunc(x);
+#endif
+    }
+
+    /**
+     * truncation toward zero
+     * @param[in] x
+     * @returns x without its fraction
+     */
+    inline float Trunc(const float x)
+    {
+#if defined(__GNUC__)
+        return __builtin_truncf(x);
+#else
+        return truncf(x);
+#endif
+    }
+
+#ifdef SGP4_SCALAR_MATH
+
+    inline void SinCos(const double x, double& s, double& c)
+    {
+        s = sin(x);
+        c = cos(x);
+    }
+
+    inline void SinCos(const float x, float& s, float& c)
+    {
+        s = sinf(x);
+        c = cosf(x);
+    }
+
+    inline double Atan2(const double y, const double x)
+    {
+        return atan2(y, x);
+    }
+
+    inline float Atan2(const float y, const float x)
+    {
+        return atan2f(y, x);
+    }
+
+    inline double Asin(const double x)
+    {
+        return asin(x);
+    }
+
+    inline float Asin(const float x)
+    {
+        return asinf(x);
+    }
+
+#else
+
+    /**
+     * sine and cosine of the same angle
+     * @param[in] x the angle in radians
+     * @param[out] s sin(x)
+     * @param[out] c cos(x)
+     */
+    inline void SinCos(const double x, double& s, double& c)
+    {
+        /*
+         * x = q * pi/2 + r, |r| <= pi/4, with pi/2 split in three so the
+         * products with q are exact
+         */
+        static const double kPIO2_1 = 1.57079632673412561417e+00;
+        static const double kPIO2_2 = 6.07710050630396597660e-11;
+        static const double kPIO2_3 = 2.02226624871116645580e-21;
+
+        const double v = x * 0.63661977236758134308;
+        const double qd = Trunc(v + (v < 0.0 ? -0.5 : 0.5));
+        const double r = ((x - qd * kPIO2_1) - qd * kPIO2_2) - qd * kPIO2_3;
+        const double z = r * r;
+
+        const double sin_r = r + r * z * (-1.66666666666666307295e-01
+                + z * (8.33333333332211858878e-03
+                + z * (-1.98412698295895385996e-04
+                + z * (2.75573136213857245213e-06
+                + z * (-2.50507477628578072866e-08
+                + z * 1.58962301576546568060e-10)))));
+        const double cos_r = 1.0 - 0.5 * z + z * z * (4.16666666666665929218e-02
+                + z * (-1.38888888888730564116e-03
+                + z * (2.48015872888517045348e-05
+                + z * (-2.75573141792967388112e-07
+                + z * (2.08757008419747316778e-09
+                + z * -1.13585365213876817300e-11)))));
+
+        /*
+         * rotate by the quadrant, the low two bits of qd taken in double
+         * so that no conversion to int can overflow
+         */
+        const double m = qd - 4.0 * Trunc(qd * 0.25);
+        const double quadrant = m < 0.0 ? m + 4.0 : m;
+        const bool swap = quadrant == 1.0 || quadrant == 3.0;
+        const double sin_q = swap ? cos_r : sin_r;
+        const double cos_q = swap ? sin_r : cos_r;
+        s = quadrant >= 2.0 ? -sin_q : sin_q;
+        c = quadrant == 1.0 || quadrant == 2.0 ? -cos_q : cos_q;
+    }
+
+    /**
+     * sine and cosine of the same angle
+     * @param[in] x the angle in radians
+     * @param[out] s sin(x)
+     * @param[out] c cos(x)
+     */
+    inline void SinCos(const float x, float& s, float& c)
+    {
+        static const float kPIO2_1 = 1.5703125f;
+        static const float kPIO2_2 = 4.837512969970703125e-4f;
+        static const float kPIO2_3 = 7.54978995489188216e-8f;
+
+        const float v = x * 0.636619772f;
+        const float qf = Trunc(v + (v < 0.0f ? -0.5f : 0.5f));
+        const float r = ((x - qf * kPIO2_1) - qf * kPIO2_2) - qf * kPIO2_3;
+        const float z = r * r;
+
+        const float sin_r = r + r * z * (-1.6666654611e-1f
+                + z * (8.3321608736e-3f
+                + z * -1.9515295891e-4f));
+        const float cos_r = 1.0f - 0.5f * z + z * z * (4.166664568298827e-2f
+                + z * (-1.388731625493765e-3f
+                + z * 2.443315711809948e-5f));
+
+        const float m = qf - 4.0f * Trunc(qf * 0.25f);
+        const float quadrant = m < 0.0f ? m + 4.0f : m;
+        const bool swap = quadrant == 1.0f || quadrant == 3.0f;
+        const float sin_q = swap ? cos_r : sin_r;
+        const float cos_q = swap ? sin_r : cos_r;
+        s = quadrant >= 2.0f ? -sin_q : sin_q;
+        c = quadrant == 1.0f || quadrant == 2.0f ? -cos_q : cos_q;
+    }
+
+    /**
+     * arc tangent of y / x, in the quadrant of (x, y)
+     * @param[in] y
+     * @param[in] x
+     * @returns the angle in (-pi, pi]
+     */
+    inline double Atan2(const double y, const double x)
+    {
+        static const double kPIO4 = 7.85398163397448278999e-01;
+        static const double kPIO2_HI = 1.57079632679489655800e+00;
+        static const double kPIO2_LO = 6.12323399573676603587e-17;
+        static const double kPI_HI = 3.14159265358979311600e+00;
+        static const double kPI_LO = 1.22464679914735317720e-16;
+
+        /*
+         * atan of t = min / max in [0, 1], reduced to |u| <= tan(pi/8)
+         * about pi/4 by u = (t - 1) / (t + 1)
+         */
+        const double ax = fabs(x);
+        const double ay = fabs(y);
+        const bool steep = ay > ax;
+        const double num = steep ? ax : ay;
+        const double den = steep ? ay : ax;
+        const double diff = num - den;
+        const double sum = num + den;
+        const double safe_den = den > 0.0 ? den : 1.0;
+
+        const bool upper = num > 0.41421356237309504880 * den;
+        const double u = (upper ? diff : num) / (upper ? sum : safe_den);
+        const double z = u * u;
+
+        const double p = (((-8.750608600031904122785e-01 * z
+                        - 1.615753718733365076637e+01) * z
+                    - 7.500855792314704667340e+01) * z
+                - 1.228866684490136173410e+02) * z
+            - 6.485021904942025371773e+01;
+        const double q = ((((z + 2.485846490142306297962e+01) * z
+                        + 1.650270098316988542046e+02) * z
+                    + 4.328810604912902668951e+02) * z
+                + 4.853903996359136964868e+02) * z
+            + 1.945506571482613964425e+02;
+
+        const double atan_u = u + u * z * p / q;
+        const double shifted = kPIO4 + (atan_u + 0.5 * kPIO2_LO);
+        const double atan_t = upper ? shifted : atan_u;
+
+        /*
+         * back to the octant, then the quadrant
+         */
+        const double reflected = (kPIO2_HI - atan_t) + kPIO2_LO;
+        const double first = steep ? reflected : atan_t;
+        const double supplement = (kPI_HI - first) + kPI_LO;
+        const double half = x < 0.0 ? supplement : first;
+
+        return y < 0.0 ? -half : half;
+    }
+
+    /**
+     * arc tangent of y / x, in the quadrant of (x, y)
+     * @param[in] y
+     * @param[in] x
+     * @returns the angle in (-pi, pi]
+     */
+    inline float Atan2(const float y, const float x)
+    {
+        static const float kPIO4 = 0.785398163f;
+        static const float kPIO2 = 1.570796327f;
+        static const float kPI = 3.141592654f;
+
+        const float ax = std::fabs(x);
+        const float ay = std::fabs(y);
+        const bool steep = ay > ax;
+        const float num = steep ? ax : ay;
+        const float den = steep ? ay : ax;
+        const float diff = num - den;
+        const float sum = num + den;
+        const float safe_den = den > 0.0f ? den : 1.0f;
+
+        const bool upper = num > 0.414213562f * den;
+        const float u = (upper ? diff : num) / (upper ? sum : safe_den);
+        const float z = u * u;
+
+        const float atan_u = u + u * z * (-3.33329491539e-1f
+                + z * (1.99777106478e-1f
+                + z * (-1.38776856032e-1f
+                + z * 8.05374449538e-2f)));
+        const float shifted = kPIO4 + atan_u;
+        const float atan_t = upper ? shifted : atan_u;
+
+        const float reflected = kPIO2 - atan_t;
+        const float first = steep ? reflected : atan_t;
+        const float supplement = kPI - first;
+        const float half = x < 0.0f ? supplement : first;
+
+        return y < 0.0f ? -half : half;
+    }
+
+    /**
+     * arc sine
+     * @param[in] x in [-1, 1]
+     * @returns the angle in [-pi/2, pi/2]
+     */
+    inline double Asin(const double x)
+    {
+        return Atan2(x, sqrt((1.0 - x) * (1.0 + x)));
+    }
+
+    /**
+     * arc sine
+     * @param[in] x in [-1, 1]
+     * @returns the angle in [-pi/2, pi/2]
+     */
+    inline float Asin(const float x)
+    {
+        return Atan2(x, std::sqrt((1.0f - x) * (1.0f + x)));
+    }
+
+#endif
+}
+
+#endif
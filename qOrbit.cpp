@@ -1,8 +1,12 @@
 #include "qorbit.h"
 #include "ui_qorbit.h"
 #include <QTimer>
+#include <QCoreApplication>
+#include <QDir>
+#include <QStringList>
 
 #include "PassCalculator.h"
+#include "CatalogWatcher.h"
 
 qOrbit::qOrbit(QWidget *parent) :
     QMainWindow(parent),
@@ -26,6 +30,19 @@ qOrbit::qOrbit(QWidget *parent) :
     timer->start();
     connect(calc, SIGNAL(listUpdated(QList<PassDetails>)), ui->tableWidget, SLOT(updateList(QList<PassDetails>)));
 
+    // Elements are taken from the catalog file whenever it changes. The file
+    // is given as the first argument, or else is catalog.txt beside the
+    // executable, whatever the working directory
+    const QStringList arguments = QCoreApplication::arguments();
+    const QString catalogFile = arguments.size() > 1
+            ? arguments.at(1)
+            : QDir(QCoreApplication::applicationDirPath()).filePath("catalog.txt");
+
+    watcher = new CatalogWatcher(catalogFile, this);
+    connect(watcher, SIGNAL(catalogChanged(Catalog,Catalog::ChangeSet)), calc, SLOT(catalogChanged(Catalog,Catalog::ChangeSet)));
+    connect(watcher, SIGNAL(catalogChanged(Catalog,Catalog::ChangeSet)), ui->mapWidget, SLOT(catalogChanged(Catalog,Catalog::ChangeSet)));
+    watcher->reload();
+
 }
 
 qOrbit::~qOrbit()
@@ -17,22 +17,29 @@ SOURCES += main.cpp \
     qOrbit.cpp \
     qPolarView.cpp \
 	QSimpleSatelliteMap.cpp \
+    libsgp4/Catalog.cpp \
+    libsgp4/ChebyshevEphemeris.cpp \
     libsgp4/CoordGeodetic.cpp \
     libsgp4/CoordTopocentric.cpp \
     libsgp4/DateTime.cpp \
     libsgp4/Eci.cpp \
     libsgp4/Globals.cpp \
     libsgp4/Observer.cpp \
+    libsgp4/OmmReader.cpp \
     libsgp4/OrbitalElements.cpp \
+    libsgp4/PropagationCursor.cpp \
     libsgp4/SGP4.cpp \
+    libsgp4/SGP4Batch.cpp \
     libsgp4/SolarPosition.cpp \
+    libsgp4/TimeGrid.cpp \
     libsgp4/TimeSpan.cpp \
     libsgp4/Tle.cpp \
     libsgp4/Util.cpp \
     libsgp4/Vector.cpp \
     PassTable.cpp \
     PassDetails.cpp \
-    PassCalculator.cpp
+    PassCalculator.cpp \
+    CatalogWatcher.cpp
 
 HEADERS  += qorbit.h \
     Footprint.h \
@@ -40,25 +47,41 @@ HEADERS  += qorbit.h \
     Satellite.h \
     ui_qorbit.h \
 	qPolarView.h \
+    libsgp4/Catalog.h \
+    libsgp4/ChebyshevEphemeris.h \
     libsgp4/CoordGeodetic.h \
     libsgp4/CoordTopocentric.h \
     libsgp4/DateTime.h \
     libsgp4/DecayedException.h \
+    libsgp4/Ecef.h \
     libsgp4/Eci.h \
     libsgp4/Globals.h \
     libsgp4/Observer.h \
+    libsgp4/Omm.h \
+    libsgp4/OmmException.h \
+    libsgp4/OmmReader.h \
+    libsgp4/OnceFlag.h \
     libsgp4/OrbitalElements.h \
+    libsgp4/PropagationCursor.h \
+    libsgp4/Propagator.h \
     libsgp4/SatelliteException.h \
     libsgp4/SGP4.h \
+    libsgp4/SGP4Batch.h \
+    libsgp4/SGP4Kernel.h \
     libsgp4/SolarPosition.h \
+    libsgp4/Threading.h \
+    libsgp4/TimeContext.h \
+    libsgp4/TimeGrid.h \
     libsgp4/TimeSpan.h \
     libsgp4/Tle.h \
     libsgp4/TleException.h \
     libsgp4/Util.h \
     libsgp4/Vector.h \
+    libsgp4/VectorMath.h \
     qpredict_footprint.h \
     PassTable.h \
     PassDetails.h \
-    PassCalculator.h
+    PassCalculator.h \
+    CatalogWatcher.h
 
 FORMS    += qorbit.ui
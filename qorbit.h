@@ -4,6 +4,7 @@
 #include <QMainWindow>
 
 class PassCalculator;
+class CatalogWatcher;
 
 namespace Ui {
 class qOrbit;
@@ -20,6 +21,7 @@ public:
 private:
     Ui::qOrbit *ui;
     PassCalculator* calc;
+    CatalogWatcher* watcher;
 };
 
 #endif // QORBIT_H
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Converts a 2LE / 3LE tle file to a binary catalog image, which
+ * Catalog::LoadImage() reads without parsing or initialising.
+ *
+ * usage: tle2image input.tle output.img
+ */
+
+#include "Catalog.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: " << argv[0] << " input.tle output.img"
+            << std::endl;
+        return 2;
+    }
+
+    Catalog catalog;
+    const bool loaded = catalog.LoadFile(argv[1]);
+
+    /*
+     * records left out are reported, the rest are still converted
+     */
+    const std::vector<Catalog::Error>& errors = catalog.Errors();
+    for (size_t i = 0; i < errors.size(); i++)
+    {
+        if (errors[i].line > 0)
+        {
+            std::cerr << argv[1] << ":" << errors[i].line << ": ";
+        }
+        std::cerr << errors[i].message << std::endl;
+    }
+
+    if (!loaded)
+    {
+        return 1;
+    }
+
+    if (!catalog.SaveImage(argv[2]))
+    {
+        std::cerr << argv[2] << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    std::cout << catalog.Size() << " satellites written, "
+        << errors.size() << " records left out" << std::endl;
+    return 0;
+}
@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Converts tle text to a binary catalog image
+#
+#-------------------------------------------------
+
+QT       -= core gui
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TARGET = tle2image
+TEMPLATE = app
+
+INCLUDEPATH += ../libsgp4
+LIBS += -lpthread
+
+SOURCES += tle2image.cpp \
+    $$files(../libsgp4/*.cpp)